@@ -4,30 +4,99 @@
  * @LastEditors: ZhangDingNian
  * @LastEditTime: 2024-04-12 10:43:21
  */
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// 墓碑和游标不是真正的数据，list_for_each_entry 系列宏会跳过它们
+#define list_entry_hidden(pos, member) ((pos)->flags & NODE_HIDDEN)
 
 #include "list.h"
+#include "list_algo.h"
+
+#define NODE_DEAD 0x01   // 墓碑：节点已被 lazy_del_node 逻辑删除，等待批量回收
+#define NODE_CURSOR 0x02 // 游标：长时间遍历中途放下的书签，不属于链表数据
+#define NODE_SLAB 0x04   // 节点来自 load_file_nodes 批量申请的内存块，由 free_node 释放
+#define NODE_FROZEN 0x08 // 冻结段：一段压缩后的数据，整体作为一个节点挂在链表中
+#define NODE_HIDDEN (NODE_DEAD | NODE_CURSOR | NODE_FROZEN)
+
+#define SLAB_SIZE (64 * 1024) // 批量申请的内存块大小，也是它的对齐大小
 
 typedef struct node
 {
     int data;
+    unsigned char flags; // 节点标记，占用 data 后面的填充字节，不增加节点大小
     struct list_head list;
 } listnode, *linklist;
 
+static int tombstone_ratio = 25; // 墓碑占比超过该百分比时，遍历结束后自动回收
+
+// 批量申请的内存块，块头占用第一个节点的位置，之后全部是节点
+typedef struct node_slab
+{
+    int refs; // 块中尚未释放的节点数，归零时释放整块
+} nodeslab;
+
+#define SLAB_NODES (SLAB_SIZE / sizeof(listnode) - 1) // 每块能放的节点数
+#define SLAB_MIN_NODES (SLAB_NODES / 2)               // 一批不到半块时逐个申请节点，不占用整块内存
+
+// 冻结段：相邻数据的差值经 zigzag 变换后按 varint 编码，读取时逐个解码
+typedef struct frozen_segment
+{
+    listnode node;          // flags 为 NODE_FROZEN，代替整段数据挂在链表中
+    int count;              // 段中的数据个数
+    size_t len;             // bytes 的长度
+    unsigned char bytes[];  // 编码后的数据
+} frozenseg;
+
 void pressAnyKeyToContinue();                                            // 按任意键继续
+static int node_data_equal(linklist node, void *arg);                    // 节点数据是否等于 *(int *)arg
+static int node_data_cmp(void *priv, struct list_head *a, struct list_head *b); // 按数据比较两个节点
+static int free_node_list(struct list_head *head);                       // 释放链表中的所有节点
+static int purge_dead_nodes(struct list_head *head, struct list_head *dead); // 摘下所有逻辑删除的节点
 int control_panel(linklist mylist);                                      // 控制面板
 linklist init_list();                                                    // 初始化一个具有表头节点的空链表
 linklist creat_new_node(int data);                                       // 创建新节点
+void free_node(linklist node);                                           // 释放节点
+long load_file_nodes(linklist mylist, const char *path, int binary);     // 从文件批量导入数据
 int head_insert_node(linklist mylist, int data);                         // 从表头插入新节点
 int tail_insert_node(linklist mylist, int data);                         // 从表尾插入新节点
 int display_linked_list(linklist mylist);                                // 打印链表数据
+int display_linked_list_in_steps(linklist mylist, int step);             // 用游标分段打印链表数据
 linklist find_node(linklist mylist, int data);                           // 查找包含指定数据的节点
+int find_nodes(linklist mylist, const int *keys, int nr_keys, linklist *result); // 一次遍历查找多个数据
 int insert_node_anywhere(linklist mylist, linklist dest_node, int data); // 任意位置插入数据
 int move_node(linklist dest_node, linklist src_node);                    // 移动节点
 int display_node(linklist node);                                         // 打印节点数据
 int del_node(linklist node);                                             // 删除节点
+int del_node_if(linklist mylist, int (*cond)(linklist node, void *arg), void *arg); // 删除所有满足条件的节点
+int reverse_link_list(linklist mylist);                                  // 反转链表
+int unique_link_list(linklist mylist);                                   // 删除相邻的重复数据
+linklist read_link_list();                                               // 从输入读取一条新链表
+int merge_link_list(linklist mylist, linklist other);                    // 合并两条有序链表
+int union_link_list(linklist mylist, linklist other);                    // 有序集合的并集
+int intersect_link_list(linklist mylist, linklist other);                // 有序集合的交集
+int difference_link_list(linklist mylist, linklist other);               // 有序集合的差集
+int lazy_del_node(linklist node);                                        // 逻辑删除节点
+int purge_link_list(linklist mylist);                                    // 回收所有逻辑删除的节点
+int set_tombstone_ratio(int ratio);                                      // 设置自动回收的墓碑占比
+linklist cursor_create();                                                // 创建游标
+int cursor_start(linklist mylist, linklist cursor);                      // 把游标放到链表开头
+int scan_link_list(linklist cursor, linklist mylist, int budget,
+                   int (*func)(linklist node, void *arg), void *arg);    // 从游标处继续遍历
+int cursor_destroy(linklist cursor);                                     // 移除并释放游标
+int freeze_link_list(linklist mylist, int count);                        // 冻结链表开头的节点
+int thaw_link_list(linklist mylist);                                     // 解冻所有冻结段
 int destroy_link_list(linklist mylist);                                  // 摧毁链表
 
 /// @brief 按任意键继续
@@ -63,6 +132,20 @@ int control_panel(linklist mylist)
         printf("mode 6: deleted node\n");
         printf("mode 7: move node\n");
         printf("mode 8: destroy linked list\n");
+        printf("mode 9: find multiple nodes\n");
+        printf("mode 10: deleted all nodes with data\n");
+        printf("mode 11: reverse linked list\n");
+        printf("mode 12: remove adjacent duplicates\n");
+        printf("mode 13: lazy delete node\n");
+        printf("mode 14: purge lazily deleted nodes\n");
+        printf("mode 15: print linked list in steps\n");
+        printf("mode 16: load data file\n");
+        printf("mode 17: freeze first nodes\n");
+        printf("mode 18: thaw frozen nodes\n");
+        printf("mode 19: merge sorted data\n");
+        printf("mode 20: union with sorted data\n");
+        printf("mode 21: intersect with sorted data\n");
+        printf("mode 22: subtract sorted data\n");
         printf("mode 0: program exit\n");
         printf("Mode Selection: ");
         scanf("%d", &mode);
@@ -123,6 +206,123 @@ int control_panel(linklist mylist)
             destroy_link_list(mylist);
             break;
 
+        case 9:
+        {
+            int nr_keys = 0;
+            printf("Please enter the number of data to search for: ");
+            scanf("%d", &nr_keys);
+            if (nr_keys <= 0)
+            {
+                printf("invalid number!\n");
+                break;
+            }
+            int *keys = (int *)calloc(nr_keys, sizeof(int));
+            linklist *result = (linklist *)calloc(nr_keys, sizeof(linklist));
+            if (keys == NULL || result == NULL)
+            {
+                perror("calloc");
+                free(keys);
+                free(result);
+                break;
+            }
+            printf("Please enter the data you want to search for: ");
+            for (int i = 0; i < nr_keys; i++)
+            {
+                scanf("%d", &keys[i]);
+            }
+            find_nodes(mylist, keys, nr_keys, result);
+            for (int i = 0; i < nr_keys; i++)
+            {
+                printf("%d: ", keys[i]);
+                display_node(result[i]);
+            }
+            free(keys);
+            free(result);
+            break;
+        }
+
+        case 10:
+            printf("Please enter the data you want to delete: ");
+            scanf("%d", &data);
+            del_node_if(mylist, node_data_equal, &data);
+            break;
+
+        case 11:
+            reverse_link_list(mylist);
+            break;
+
+        case 12:
+            unique_link_list(mylist);
+            break;
+
+        case 13:
+            printf("Please enter the data you want to delete: ");
+            scanf("%d", &data);
+            lazy_del_node(find_node(mylist, data));
+            break;
+
+        case 14:
+            purge_link_list(mylist);
+            break;
+
+        case 15:
+            printf("Please enter the number of nodes per step: ");
+            scanf("%d", &data);
+            display_linked_list_in_steps(mylist, data);
+            break;
+
+        case 16:
+        {
+            char path[256];
+            printf("Please enter the file path: ");
+            scanf("%255s", path);
+            printf("Is it a binary file of int (1: yes, 0: text)? ");
+            scanf("%d", &data);
+            load_file_nodes(mylist, path, data);
+            break;
+        }
+
+        case 17:
+            printf("Please enter the number of nodes to freeze: ");
+            scanf("%d", &data);
+            freeze_link_list(mylist, data);
+            break;
+
+        case 18:
+            thaw_link_list(mylist);
+            break;
+
+        case 19:
+        case 20:
+        case 21:
+        case 22:
+        {
+            linklist other = read_link_list();
+            if (other == (linklist)NULL)
+            {
+                break;
+            }
+            if (mode == 19)
+            {
+                merge_link_list(mylist, other);
+            }
+            else if (mode == 20)
+            {
+                union_link_list(mylist, other);
+            }
+            else if (mode == 21)
+            {
+                intersect_link_list(mylist, other);
+            }
+            else
+            {
+                difference_link_list(mylist, other);
+            }
+            free_node_list(&other->list);
+            free(other);
+            break;
+        }
+
         default:
             printf("There is no such mode!\n");
             break;
@@ -167,174 +367,1457 @@ linklist creat_new_node(int data)
     return new;
 }
 
-/// @brief 从表头插入新节点
-/// @param mylist 指向表头的指针
-/// @param data 新节点的数据
+/// @brief 释放节点，批量导入的节点归还给所属的内存块
+/// @param node 指向节点的指针
+void free_node(linklist node)
+{
+    if (node->flags & NODE_SLAB)
+    {
+        nodeslab *slab = (nodeslab *)((uintptr_t)node & ~(uintptr_t)(SLAB_SIZE - 1));
+        if (--slab->refs == 0)
+        {
+            free(slab);
+        }
+    }
+    else
+    {
+        free(node);
+    }
+}
+
+/// @brief 把一批数据做成节点，整批拼接到 head 之前
+/// @param head 插入位置，传入表头即拼接到链表尾部
+/// @param values 数据
+/// @param nr 数据个数，不超过 SLAB_NODES
 /// @return 成功，返回 0。失败，返回 -1。
-int head_insert_node(linklist mylist, int data)
+/// @note 不少于 SLAB_MIN_NODES 个时放在一块连续内存中，否则逐个申请，
+///       解冻很小的冻结段或导入很小的文件时不会为几个节点占用 SLAB_SIZE 字节。
+static int append_node_batch(struct list_head *head, const int *values, size_t nr)
 {
-    linklist new = creat_new_node(data);
-    if (new != NULL)
+    LIST_HEAD(batch);
+
+    if (nr < SLAB_MIN_NODES)
     {
-        list_add(&new->list, &mylist->list);
-        printf("Node add success!\n");
+        for (size_t i = 0; i < nr; i++)
+        {
+            linklist node = creat_new_node(values[i]);
+            if (node == (linklist)NULL)
+            {
+                free_node_list(&batch);
+                return -1;
+            }
+            list_add_tail(&node->list, &batch);
+        }
+        list_splice_tail(&batch, head);
         return 0;
     }
-    else
+
+    nodeslab *slab = (nodeslab *)aligned_alloc(SLAB_SIZE, SLAB_SIZE);
+    if (slab == NULL)
     {
-        printf("Node add failed!\n");
+        perror("aligned_alloc");
         return -1;
     }
+    slab->refs = (int)nr;
+
+    linklist nodes = (linklist)slab + 1;
+    for (size_t i = 0; i < nr; i++)
+    {
+        nodes[i].data = values[i];
+        nodes[i].flags = NODE_SLAB;
+        list_add_tail(&nodes[i].list, &batch);
+    }
+    list_splice_tail(&batch, head);
+
+    return 0;
 }
 
-/// @brief 从表尾插入新节点
+/// @brief 是否为数据之间的分隔符：空白或逗号
+static inline int is_separator(char c)
+{
+    return c == ' ' || c == ',' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+/// @brief 解析文本中的整数，用 SSE2 一次检查 16 个字节跳过分隔符
+/// @param begin 整个文本的起始位置，用于报告出错的偏移
+/// @param pos 解析的起始位置，返回时为解析停止的位置
+/// @param end 文本结束位置
+/// @param values 解析结果
+/// @param max 最多解析的个数
+/// @return 成功，返回解析出的整数个数。遇到非法字符或超出 int 范围的数，返回 -1。
+static long parse_ints(const char *begin, const char **pos, const char *end, int *values, size_t max)
+{
+    const char *p = *pos;
+    size_t nr = 0;
+
+    while (nr < max)
+    {
+#if defined(__SSE2__)
+        // 整块都是分隔符时直接跳过，'\t' 到 '\r' 用一次有符号比较判断
+        while (end - p >= 16)
+        {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+            __m128i sep = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                                       _mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')));
+            __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8('\t' - 128));
+            sep = _mm_or_si128(sep, _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + ('\r' - '\t' + 1))));
+            unsigned int mask = ~(unsigned int)_mm_movemask_epi8(sep) & 0xffff;
+            if (mask != 0)
+            {
+                p += __builtin_ctz(mask);
+                break;
+            }
+            p += 16;
+        }
+#endif
+        while (p < end && is_separator(*p))
+        {
+            p++;
+        }
+        if (p == end)
+        {
+            break;
+        }
+
+        const char *token = p;
+        int negative = (*p == '-');
+        if (negative)
+        {
+            p++;
+        }
+        if (p == end || (unsigned char)(*p - '0') > 9)
+        {
+            printf("Invalid number at offset %ld!\n", (long)(token - begin));
+            *pos = token;
+            return -1;
+        }
+
+        // 超出范围立即停止，不会溢出
+        long long limit = negative ? -(long long)INT_MIN : INT_MAX;
+        long long v = 0;
+        while (p < end && (unsigned char)(*p - '0') <= 9)
+        {
+            v = v * 10 + (*p - '0');
+            if (v > limit)
+            {
+                printf("Number out of range at offset %ld!\n", (long)(token - begin));
+                *pos = token;
+                return -1;
+            }
+            p++;
+        }
+        if (p < end && !is_separator(*p))
+        {
+            printf("Invalid character at offset %ld!\n", (long)(p - begin));
+            *pos = p;
+            return -1;
+        }
+        values[nr++] = (int)(negative ? -v : v);
+    }
+
+    *pos = p;
+    return (long)nr;
+}
+
+/// @brief 从文件批量导入数据到链表尾部
 /// @param mylist 指向表头的指针
-/// @param data 新节点的数据
-/// @return 成功，返回 0。失败，返回 -1。
-int tail_insert_node(linklist mylist, int data)
+/// @param path 文件路径
+/// @param binary 非 0 时文件内容为原始的 int 数组，否则为空白或逗号分隔的十进制整数
+/// @return 成功，返回导入的节点个数。失败，返回 -1，链表保持不变。
+/// @note 文件通过 mmap 映射，节点按 SLAB_NODES 个一批放在连续内存中，每批只做一次 list_splice_tail。
+///       文本中只允许空白和逗号作为分隔符，遇到其他字符或超出 int 范围的数时报告偏移并放弃整个文件。
+long load_file_nodes(linklist mylist, const char *path, int binary)
 {
-    linklist new = creat_new_node(data);
-    if (new != NULL)
+    if (mylist == (linklist)NULL || path == NULL)
     {
-        list_add_tail(&new->list, &mylist->list);
-        printf("Node add sucess!\n");
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror("open");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        perror("fstat");
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    if (size == 0)
+    {
+        close(fd);
+        printf("0 node(s) loaded!\n");
         return 0;
     }
+    if (binary && size % sizeof(int) != 0)
+    {
+        close(fd);
+        printf("File size %zu is not a multiple of %zu, %zu trailing byte(s)!\n",
+               size, sizeof(int), size % sizeof(int));
+        return -1;
+    }
+    const char *buf = (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (buf == MAP_FAILED)
+    {
+        perror("mmap");
+        return -1;
+    }
+    madvise((void *)buf, size, MADV_SEQUENTIAL);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    // 先导入到临时链表，全部成功后再接到链表尾部
+    LIST_HEAD(loaded);
+    int values[SLAB_NODES];
+    long total = 0;
+    int ret = 0;
+    if (binary)
+    {
+        const int *src = (const int *)buf;
+        size_t count = size / sizeof(int);
+        for (size_t i = 0; i < count && ret == 0; i += SLAB_NODES)
+        {
+            size_t nr = count - i < SLAB_NODES ? count - i : SLAB_NODES;
+            ret = append_node_batch(&loaded, src + i, nr);
+            total += ret == 0 ? (long)nr : 0;
+        }
+    }
     else
     {
-        printf("Node add failed!\n");
+        const char *p = buf;
+        const char *end = buf + size;
+        while (p < end && ret == 0)
+        {
+            long nr = parse_ints(buf, &p, end, values, SLAB_NODES);
+            if (nr <= 0)
+            {
+                ret = (int)nr;
+                break;
+            }
+            ret = append_node_batch(&loaded, values, (size_t)nr);
+            total += ret == 0 ? nr : 0;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    munmap((void *)buf, size);
+    if (ret != 0)
+    {
+        free_node_list(&loaded);
+        printf("Failed to load %s, list unchanged!\n", path);
         return -1;
     }
+    list_splice_tail(&loaded, &mylist->list);
+
+    double sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    if (sec <= 0)
+    {
+        sec = 1e-9;
+    }
+    printf("%ld node(s) loaded in %.3f s, %.1f MB/s, %.0f nodes/s\n",
+           total, sec, size / sec / (1024 * 1024), total / sec);
+
+    return total;
 }
 
-/// @brief 打印链表数据
-/// @param mylist 指向表头的指针
-/// @return 成功，返回 0。失败，返回 -1。
-int display_linked_list(linklist mylist)
+/// @brief 解码冻结段中的下一个数据
+/// @param p 指向编码位置的指针，解码后向后移动
+/// @param prev 上一个数据
+/// @return 解码出的数据
+static inline int frozen_next(const unsigned char **p, int prev)
 {
-    linklist tmp;
+    uint64_t zz = 0;
+    int shift = 0;
+    unsigned char byte;
 
-    printf("link list: ");
-    list_for_each_entry(tmp, &mylist->list, list)
+    do
     {
-        printf("%d ", tmp->data);
-    }
-    printf("\n");
+        byte = *(*p)++;
+        zz |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return (int)(prev + (int64_t)((zz >> 1) ^ -(zz & 1)));
 }
 
-/// @brief 查找包含指定数据的节点
-/// @param mylist 指向表头的指针
-/// @param data 新节点的数据
-/// @return 成功，返回指向包含指定数据的节点的指针。失败，返回 NULL。
-linklist find_node(linklist mylist, int data)
+/// @brief 把一条链表中的节点数据编码成冻结段，不修改原链表
+/// @param range 指向内核链表表头的指针，其中不能有墓碑、游标和冻结段
+/// @param count range 中的节点数
+/// @return 成功，返回指向冻结段的指针。失败，返回 NULL。
+static frozenseg *freeze_nodes(struct list_head *range, int count)
 {
-    if (list_empty(&mylist->list))
+    // 每个差值最多 33 位，varint 编码后最多 5 个字节
+    frozenseg *seg = (frozenseg *)malloc(sizeof(frozenseg) + (size_t)count * 5);
+    if (seg == NULL)
     {
-        return (linklist)NULL;
+        perror("malloc");
+        return NULL;
     }
 
+    unsigned char *p = seg->bytes;
+    int prev = 0;
     linklist pos;
-    list_for_each_entry(pos, &mylist->list, list)
+    list_for_each_entry(pos, range, list)
     {
-        if (pos->data == data)
+        int64_t delta = (int64_t)pos->data - prev;
+        uint64_t zz = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+        while (zz >= 0x80)
         {
-            // printf("Target node found!\n");
-            return pos;
+            *p++ = (unsigned char)(zz | 0x80);
+            zz >>= 7;
         }
+        *p++ = (unsigned char)zz;
+        prev = pos->data;
     }
-    // printf("Target node not found!\n");
-    return NULL;
+
+    seg->count = count;
+    seg->len = (size_t)(p - seg->bytes);
+    frozenseg *shrunk = (frozenseg *)realloc(seg, sizeof(frozenseg) + seg->len);
+    if (shrunk != NULL)
+    {
+        seg = shrunk;
+    }
+    memset(&seg->node, 0, sizeof(seg->node));
+    seg->node.flags = NODE_FROZEN;
+    INIT_LIST_HEAD(&seg->node.list);
+
+    return seg;
 }
 
-/// @brief 任意位置插入数据
+/// @brief 把冻结段还原成普通节点，放回冻结段原来的位置
+/// @param seg 指向冻结段的指针
+/// @return 成功，返回还原出的第一个节点的前驱，便于调用者继续遍历。失败，返回 NULL，冻结段保持不变。
+static struct list_head *thaw_segment(frozenseg *seg)
+{
+    struct list_head *prev = seg->node.list.prev;
+    const unsigned char *p = seg->bytes;
+    int values[SLAB_NODES];
+    int v = 0;
+    int done = 0;
+
+    while (done < seg->count)
+    {
+        int nr = 0;
+        while (nr < (int)SLAB_NODES && done + nr < seg->count)
+        {
+            v = frozen_next(&p, v);
+            values[nr++] = v;
+        }
+        if (append_node_batch(&seg->node.list, values, nr) != 0)
+        {
+            // 撤销已经还原的节点
+            while (prev->next != &seg->node.list)
+            {
+                linklist tmp = list_entry(prev->next, listnode, list);
+                list_del(&tmp->list);
+                free_node(tmp);
+            }
+            return NULL;
+        }
+        done += nr;
+    }
+
+    list_del(&seg->node.list);
+    free(seg);
+    return prev;
+}
+
+/// @brief 冻结链表开头的节点：用 list_cut_position 切下后压缩成一个冻结段，放回原位
 /// @param mylist 指向表头的指针
-/// @param dest_node 指向插入位置节点的指针
-/// @param data 新节点的数据
-/// @return 成功，返回 0。失败，返回 -1。
-int insert_node_anywhere(linklist mylist, linklist dest_node, int data)
+/// @param count 最多冻结的节点数，遇到游标或冻结段时提前停止
+/// @return 成功，返回冻结的数据个数。失败，返回 -1。
+/// @note 冻结段中的数据在遍历时逐个解码，查找命中、删除或改变顺序时自动解冻。
+int freeze_link_list(linklist mylist, int count)
 {
-    if (dest_node == (linklist)NULL)
+    if (mylist == (linklist)NULL || count <= 0)
     {
+        printf("invalid number!\n");
         return -1;
     }
 
-    linklist new = creat_new_node(data);
-    if (new != (linklist)NULL)
+    struct list_head *pos, *last = &mylist->list;
+    int nr = 0;
+    list_for_each(pos, &mylist->list)
     {
-        list_add(&new->list, &dest_node->list);
-        printf("Node add sucess!\n");
+        linklist tmp = list_entry(pos, listnode, list);
+        if (nr == count || (tmp->flags & (NODE_CURSOR | NODE_FROZEN)))
+        {
+            break;
+        }
+        last = pos;
+        nr++;
+    }
+    if (nr == 0)
+    {
+        printf("Nothing to freeze!\n");
         return 0;
     }
-    else
+
+    LIST_HEAD(range);
+    LIST_HEAD(dead);
+    list_cut_position(&range, &mylist->list, last);
+    nr -= purge_dead_nodes(&range, &dead);
+    free_node_list(&dead);
+    if (nr == 0)
     {
-        printf("Node add failed!\n");
-        return -1;
+        printf("Nothing to freeze!\n");
+        return 0;
     }
-}
 
-/// @brief 移动节点
-/// @param dest_node 指向目标节点的指针
-/// @param src_node 指向原节点的指针
-/// @return 成功，返回 0。失败，返回 -1。
-int move_node(linklist dest_node, linklist src_node)
-{
-    if (dest_node == (linklist)NULL)
+    frozenseg *seg = freeze_nodes(&range, nr);
+    if (seg == NULL)
     {
-        printf("Dest node not found!\n");
+        list_splice(&range, &mylist->list);
         return -1;
     }
-    if (src_node == (linklist)NULL)
+    free_node_list(&range);
+    list_add(&seg->node.list, &mylist->list);
+
+    // 统计一次完整解码的速度
+    struct timespec t0, t1;
+    const unsigned char *p = seg->bytes;
+    volatile long sum = 0;
+    int v = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < seg->count; i++)
     {
-        printf("Src node not found!\n");
-        return -1;
+        v = frozen_next(&p, v);
+        sum += v;
     }
-    if (src_node == dest_node)
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    if (sec <= 0)
     {
-        printf("Same nodes do not need to be moved!\n");
-        return 0;
+        sec = 1e-9;
     }
-    
-    list_move(&src_node->list, &dest_node->list);
-    printf("Node move sucess!\n");
-    return 0;
+
+    size_t before = (size_t)nr * sizeof(listnode);
+    size_t after = sizeof(frozenseg) + seg->len;
+    printf("%d node(s) frozen: %zu bytes -> %zu bytes (%.1fx smaller), decode %.0f nodes/s\n",
+           nr, before, after, (double)before / after, nr / sec);
+    return nr;
 }
 
-/// @brief 打印节点数据
-/// @param node 指向节点的指针
-/// @return 成功，返回 0。失败，返回 -1。
-int display_node(linklist node)
+/// @brief 解冻所有冻结段
+/// @param mylist 指向表头的指针
+/// @return 成功，返回解冻的冻结段个数。失败，返回 -1。
+int thaw_link_list(linklist mylist)
 {
-    if (node == (linklist)NULL)
+    if (mylist == (linklist)NULL)
     {
         printf("invalid node!\n");
         return -1;
     }
-    else
+
+    struct list_head *pos;
+    int count = 0;
+    list_for_each(pos, &mylist->list)
     {
-        printf("%d\n", node->data);
-        return 0;
+        linklist tmp = list_entry(pos, listnode, list);
+        if (tmp->flags & NODE_FROZEN)
+        {
+            struct list_head *prev = thaw_segment((frozenseg *)tmp);
+            if (prev == NULL)
+            {
+                return -1;
+            }
+            pos = prev;
+            count++;
+        }
     }
+
+    return count;
 }
 
-/// @brief 删除节点
-/// @param node 指向节点的指针
+/// @brief 从表头插入新节点
+/// @param mylist 指向表头的指针
+/// @param data 新节点的数据
 /// @return 成功，返回 0。失败，返回 -1。
-int del_node(linklist node)
+int head_insert_node(linklist mylist, int data)
 {
-    if (node == (linklist)NULL)
+    linklist new = creat_new_node(data);
+    if (new != NULL)
     {
-        printf("invalid node!\n");
-        return -1;
+        list_add(&new->list, &mylist->list);
+        printf("Node add success!\n");
+        return 0;
     }
     else
     {
-        list_del(&node->list);
-        free(node);
-        printf("Node deleted successfully!\n");
-        return 0;
+        printf("Node add failed!\n");
+        return -1;
     }
 }
 
+/// @brief 从表尾插入新节点
+/// @param mylist 指向表头的指针
+/// @param data 新节点的数据
+/// @return 成功，返回 0。失败，返回 -1。
+int tail_insert_node(linklist mylist, int data)
+{
+    linklist new = creat_new_node(data);
+    if (new != NULL)
+    {
+        list_add_tail(&new->list, &mylist->list);
+        printf("Node add sucess!\n");
+        return 0;
+    }
+    else
+    {
+        printf("Node add failed!\n");
+        return -1;
+    }
+}
+
+/// @brief 打印链表数据
+/// @param mylist 指向表头的指针
+/// @return 成功，返回 0。失败，返回 -1。
+/// @note 顺便统计墓碑个数，墓碑占比超过 tombstone_ratio 时批量回收。
+int display_linked_list(linklist mylist)
+{
+    struct list_head *pos;
+    int total = 0;
+    int dead = 0;
+
+    printf("link list: ");
+    list_for_each(pos, &mylist->list)
+    {
+        linklist tmp = list_entry(pos, listnode, list);
+        if (tmp->flags & NODE_CURSOR)
+        {
+            continue;
+        }
+        if (tmp->flags & NODE_FROZEN)
+        {
+            frozenseg *seg = (frozenseg *)tmp;
+            const unsigned char *p = seg->bytes;
+            int v = 0;
+            for (int i = 0; i < seg->count; i++)
+            {
+                v = frozen_next(&p, v);
+                printf("%d ", v);
+            }
+            total += seg->count;
+            continue;
+        }
+        total++;
+        if (tmp->flags & NODE_DEAD)
+        {
+            dead++;
+            continue;
+        }
+        printf("%d ", tmp->data);
+    }
+    printf("\n");
+
+    if (dead > 0 && dead * 100 > total * tombstone_ratio)
+    {
+        purge_link_list(mylist);
+    }
+    return 0;
+}
+
+/// @brief 打印节点数据，供 scan_link_list 使用
+/// @param node 指向节点的指针
+/// @param arg 未使用
+/// @return 总是返回 0，继续遍历
+static int print_node_data(linklist node, void *arg)
+{
+    printf("%d ", node->data);
+    return 0;
+}
+
+/// @brief 用游标分段打印链表数据，每段之间不持有链表，其他线程可以修改链表
+/// @param mylist 指向表头的指针
+/// @param step 每段打印的节点数
+/// @return 成功，返回 0。失败，返回 -1。
+int display_linked_list_in_steps(linklist mylist, int step)
+{
+    if (mylist == (linklist)NULL || step <= 0)
+    {
+        printf("invalid number!\n");
+        return -1;
+    }
+
+    linklist cursor = cursor_create();
+    if (cursor == (linklist)NULL)
+    {
+        return -1;
+    }
+
+    printf("link list: ");
+    cursor_start(mylist, cursor);
+    int ret;
+    while ((ret = scan_link_list(cursor, mylist, step, print_node_data, NULL)) == 1)
+    {
+        printf("| ");
+    }
+    printf("\n");
+
+    cursor_destroy(cursor);
+    return ret == 0 ? 0 : -1;
+}
+
+/// @brief 判断冻结段中是否有指定数据
+/// @param seg 指向冻结段的指针
+/// @param data 数据
+/// @return 有，返回 1。没有，返回 0。
+static int frozen_contains(frozenseg *seg, int data)
+{
+    const unsigned char *p = seg->bytes;
+    int v = 0;
+
+    for (int i = 0; i < seg->count; i++)
+    {
+        v = frozen_next(&p, v);
+        if (v == data)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/// @brief 查找包含指定数据的节点
+/// @param mylist 指向表头的指针
+/// @param data 新节点的数据
+/// @return 成功，返回指向包含指定数据的节点的指针。失败，返回 NULL。
+linklist find_node(linklist mylist, int data)
+{
+    if (list_empty(&mylist->list))
+    {
+        return (linklist)NULL;
+    }
+
+    struct list_head *p;
+    list_for_each(p, &mylist->list)
+    {
+        linklist pos = list_entry(p, listnode, list);
+        // 冻结段中有要找的数据时先解冻，调用者拿到节点后可能修改它
+        if (pos->flags & NODE_FROZEN)
+        {
+            if (frozen_contains((frozenseg *)pos, data))
+            {
+                struct list_head *prev = thaw_segment((frozenseg *)pos);
+                if (prev == NULL)
+                {
+                    printf("Failed to thaw frozen nodes!\n");
+                    return NULL;
+                }
+                p = prev;
+            }
+            continue;
+        }
+        if (pos->flags & NODE_HIDDEN)
+        {
+            continue;
+        }
+        if (pos->data == data)
+        {
+            // printf("Target node found!\n");
+            return pos;
+        }
+    }
+    // printf("Target node not found!\n");
+    return NULL;
+}
+
+/// @brief 在一个节点上用 SIMD 同时比较一组数据，记录首次匹配的位置
+/// @param pos 指向当前节点的指针
+/// @param keys 要查找的数据
+/// @param nr_keys 数据个数
+/// @param result 查找结果
+/// @return 本次新找到的数据个数
+static int match_keys(linklist pos, const int *keys, int nr_keys, linklist *result)
+{
+    int found = 0;
+    int i = 0;
+
+#if defined(__AVX2__)
+    __m256i v8 = _mm256_set1_epi32(pos->data);
+    for (; i + 8 <= nr_keys; i += 8)
+    {
+        __m256i k = _mm256_loadu_si256((const __m256i *)(keys + i));
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v8, k)));
+        while (mask)
+        {
+            int j = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+            if (result[j] == NULL)
+            {
+                result[j] = pos;
+                found++;
+            }
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i v4 = _mm_set1_epi32(pos->data);
+    for (; i + 4 <= nr_keys; i += 4)
+    {
+        __m128i k = _mm_loadu_si128((const __m128i *)(keys + i));
+        unsigned int mask = (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v4, k)));
+        while (mask)
+        {
+            int j = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+            if (result[j] == NULL)
+            {
+                result[j] = pos;
+                found++;
+            }
+        }
+    }
+#endif
+    for (; i < nr_keys; i++)
+    {
+        if (keys[i] == pos->data && result[i] == NULL)
+        {
+            result[i] = pos;
+            found++;
+        }
+    }
+
+    return found;
+}
+
+/// @brief 一次遍历查找多个数据，效果等同于对每个数据调用 find_node
+/// @param mylist 指向表头的指针
+/// @param keys 要查找的数据
+/// @param nr_keys 数据个数
+/// @param result 查找结果，result[i] 为包含 keys[i] 的第一个节点，找不到为 NULL
+/// @return 成功，返回找到的数据个数。失败，返回 -1。
+int find_nodes(linklist mylist, const int *keys, int nr_keys, linklist *result)
+{
+    if (mylist == (linklist)NULL || keys == NULL || result == NULL || nr_keys < 0)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < nr_keys; i++)
+    {
+        result[i] = NULL;
+    }
+
+    int found = 0;
+    struct list_head *p;
+    list_for_each(p, &mylist->list)
+    {
+        linklist pos = list_entry(p, listnode, list);
+        // 冻结段：先用临时节点逐个比较解码出的数据，有命中再解冻，让真正的节点重新匹配
+        if (pos->flags & NODE_FROZEN)
+        {
+            frozenseg *seg = (frozenseg *)pos;
+            const unsigned char *bytes = seg->bytes;
+            listnode tmp;
+            int hit = 0;
+            tmp.data = 0;
+            for (int i = 0; i < seg->count; i++)
+            {
+                tmp.data = frozen_next(&bytes, tmp.data);
+                hit += match_keys(&tmp, keys, nr_keys, result);
+            }
+            if (hit > 0)
+            {
+                for (int i = 0; i < nr_keys; i++)
+                {
+                    result[i] = (result[i] == &tmp) ? NULL : result[i];
+                }
+                // 解冻失败时命中的数据没有真正的节点可以返回，不能当作没找到
+                struct list_head *prev = thaw_segment(seg);
+                if (prev == NULL)
+                {
+                    printf("Failed to thaw frozen nodes!\n");
+                    return -1;
+                }
+                p = prev;
+            }
+            continue;
+        }
+        if (pos->flags & NODE_HIDDEN)
+        {
+            continue;
+        }
+        found += match_keys(pos, keys, nr_keys, result);
+        if (found == nr_keys)
+        {
+            break;
+        }
+    }
+
+    return found;
+}
+
+/// @brief 任意位置插入数据
+/// @param mylist 指向表头的指针
+/// @param dest_node 指向插入位置节点的指针
+/// @param data 新节点的数据
+/// @return 成功，返回 0。失败，返回 -1。
+int insert_node_anywhere(linklist mylist, linklist dest_node, int data)
+{
+    if (dest_node == (linklist)NULL)
+    {
+        return -1;
+    }
+
+    linklist new = creat_new_node(data);
+    if (new != (linklist)NULL)
+    {
+        list_add(&new->list, &dest_node->list);
+        printf("Node add sucess!\n");
+        return 0;
+    }
+    else
+    {
+        printf("Node add failed!\n");
+        return -1;
+    }
+}
+
+/// @brief 移动节点
+/// @param dest_node 指向目标节点的指针
+/// @param src_node 指向原节点的指针
+/// @return 成功，返回 0。失败，返回 -1。
+int move_node(linklist dest_node, linklist src_node)
+{
+    if (dest_node == (linklist)NULL)
+    {
+        printf("Dest node not found!\n");
+        return -1;
+    }
+    if (src_node == (linklist)NULL)
+    {
+        printf("Src node not found!\n");
+        return -1;
+    }
+    if (src_node == dest_node)
+    {
+        printf("Same nodes do not need to be moved!\n");
+        return 0;
+    }
+    
+    list_move(&src_node->list, &dest_node->list);
+    printf("Node move sucess!\n");
+    return 0;
+}
+
+/// @brief 打印节点数据
+/// @param node 指向节点的指针
+/// @return 成功，返回 0。失败，返回 -1。
+int display_node(linklist node)
+{
+    if (node == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+    else
+    {
+        printf("%d\n", node->data);
+        return 0;
+    }
+}
+
+/// @brief 删除节点
+/// @param node 指向节点的指针
+/// @return 成功，返回 0。失败，返回 -1。
+int del_node(linklist node)
+{
+    if (node == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+    else
+    {
+        list_del(&node->list);
+        free_node(node);
+        printf("Node deleted successfully!\n");
+        return 0;
+    }
+}
+
+/// @brief 判断节点数据是否等于指定数据，供 del_node_if 使用
+/// @param node 指向节点的指针
+/// @param arg 指向 int 数据的指针
+/// @return 相等，返回 1。不相等，返回 0。
+static int node_data_equal(linklist node, void *arg)
+{
+    return node->data == *(int *)arg;
+}
+
+/// @brief 按数据比较两个节点，供 list_algo.h 中的有序链表算法使用
+/// @param priv 未使用
+/// @param a 指向第一个节点链表结构的指针
+/// @param b 指向第二个节点链表结构的指针
+/// @return a 小于 b 返回负数，相等返回 0，大于返回正数。
+/// @note 游标不与任何节点相等，保证它不会被当作重复数据删除。
+static int node_data_cmp(void *priv, struct list_head *a, struct list_head *b)
+{
+    linklist na = list_entry(a, listnode, list);
+    linklist nb = list_entry(b, listnode, list);
+
+    if ((na->flags | nb->flags) & NODE_CURSOR)
+    {
+        return (na->flags & NODE_CURSOR) ? -1 : 1;
+    }
+
+    int x = na->data;
+    int y = nb->data;
+
+    return (x > y) - (x < y);
+}
+
+/// @brief 释放链表中的所有节点，不再逐个 list_del，最后重新初始化表头
+/// @param head 指向内核链表表头的指针
+/// @return 释放的节点个数
+static int free_node_list(struct list_head *head)
+{
+    struct list_head *pos, *q;
+    int count = 0;
+
+    list_for_each_safe(pos, q, head)
+    {
+        linklist tmp = list_entry(pos, listnode, list);
+        // 游标归遍历者所有，只把它摘下来，继续遍历时会发现链表已经结束
+        if (tmp->flags & NODE_CURSOR)
+        {
+            INIT_LIST_HEAD(pos);
+            continue;
+        }
+        count += (tmp->flags & NODE_FROZEN) ? ((frozenseg *)tmp)->count : 1;
+        free_node(tmp);
+    }
+    INIT_LIST_HEAD(head);
+
+    return count;
+}
+
+/// @brief 把所有逻辑删除的节点摘到另一条链表上
+/// @param head 指向内核链表表头的指针
+/// @param dead 接收墓碑节点的链表
+/// @return 摘下的节点个数
+static int purge_dead_nodes(struct list_head *head, struct list_head *dead)
+{
+    struct list_head *pos, *q;
+    int count = 0;
+
+    // list_for_each_entry 系列宏会跳过墓碑，这里必须用 list_for_each_safe
+    list_for_each_safe(pos, q, head)
+    {
+        if (list_entry(pos, listnode, list)->flags & NODE_DEAD)
+        {
+            list_move_tail(pos, dead);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/// @brief 删除所有满足条件的节点，一次遍历摘下全部节点后统一释放
+/// @param mylist 指向表头的指针
+/// @param cond 条件函数，返回非 0 的节点会被删除
+/// @param arg 传给条件函数的参数
+/// @return 成功，返回删除的节点个数。失败，返回 -1。
+int del_node_if(linklist mylist, int (*cond)(linklist node, void *arg), void *arg)
+{
+    if (mylist == (linklist)NULL || cond == NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    // 冻结段中有要删除的数据时先解冻，list_partition 只处理真正的节点
+    struct list_head *p;
+    list_for_each(p, &mylist->list)
+    {
+        linklist tmp = list_entry(p, listnode, list);
+        if (tmp->flags & NODE_FROZEN)
+        {
+            frozenseg *seg = (frozenseg *)tmp;
+            const unsigned char *bytes = seg->bytes;
+            listnode value;
+            int hit = 0;
+            value.data = 0;
+            value.flags = 0;
+            INIT_LIST_HEAD(&value.list);
+            for (int i = 0; i < seg->count && !hit; i++)
+            {
+                value.data = frozen_next(&bytes, value.data);
+                hit = cond(&value, arg);
+            }
+            if (hit)
+            {
+                // 解冻失败时段中匹配的数据删不掉，不能当作成功
+                struct list_head *prev = thaw_segment(seg);
+                if (prev == NULL)
+                {
+                    printf("Failed to thaw frozen nodes!\n");
+                    return -1;
+                }
+                p = prev;
+            }
+        }
+    }
+
+    LIST_HEAD(deleted);
+    linklist pos, n;
+    list_partition(pos, n, &mylist->list, &deleted, list, cond(pos, arg));
+
+    int count = free_node_list(&deleted);
+    printf("%d node(s) deleted successfully!\n", count);
+    return count;
+}
+
+/// @brief 批量操作前摘下链表中的所有游标，记下它们的位置。游标的 data 不属于链表数据，借来保存位置
+/// @param head 指向内核链表表头的指针
+/// @param front 接收之前没有真正节点的游标
+/// @param parked 接收其余游标，保持原来的顺序
+/// @param by_index 非 0 时记下游标之前的真正节点个数，否则记下它之前最近的真正节点的数据
+static void park_cursors(struct list_head *head, struct list_head *front, struct list_head *parked, int by_index)
+{
+    struct list_head *pos, *q;
+    int index = 0;
+    int last = 0;
+
+    list_for_each_safe(pos, q, head)
+    {
+        linklist tmp = list_entry(pos, listnode, list);
+        if (tmp->flags & NODE_CURSOR)
+        {
+            tmp->data = by_index ? index : last;
+            list_move_tail(pos, index == 0 ? front : parked);
+        }
+        else if (!(tmp->flags & NODE_HIDDEN))
+        {
+            last = tmp->data;
+            index++;
+        }
+    }
+}
+
+/// @brief 把 park_cursors 摘下的游标放回等价的位置
+/// @param head 指向内核链表表头的指针
+/// @param front 放回表头的游标
+/// @param parked 其余游标
+/// @param by_index 非 0 时放在相同个数的真正节点之后，否则放在最后一个数据不大于记下的数据的节点之后
+static void unpark_cursors(struct list_head *head, struct list_head *front, struct list_head *parked, int by_index)
+{
+    struct list_head *p = head;
+    int index = 0;
+
+    while (!list_empty(parked))
+    {
+        linklist cursor = list_first_entry(parked, listnode, list);
+        while (p->next != head)
+        {
+            linklist next = list_entry(p->next, listnode, list);
+            if (!(next->flags & NODE_HIDDEN))
+            {
+                if (by_index ? index == cursor->data : next->data > cursor->data)
+                {
+                    break;
+                }
+                index++;
+            }
+            p = p->next;
+        }
+        list_move(&cursor->list, p);
+        p = &cursor->list;
+    }
+    list_splice(front, head);
+}
+
+/// @brief 原地反转链表
+/// @param mylist 指向表头的指针
+/// @return 成功，返回 0。失败，返回 -1。
+/// @note 游标不参与反转，仍停在相同个数的节点之后。
+int reverse_link_list(linklist mylist)
+{
+    if (mylist == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    // 冻结段内部的顺序无法原地反转，先解冻
+    LIST_HEAD(front);
+    LIST_HEAD(parked);
+    thaw_link_list(mylist);
+    park_cursors(&mylist->list, &front, &parked, 1);
+    list_reverse(&mylist->list);
+    unpark_cursors(&mylist->list, &front, &parked, 1);
+    printf("Linked list reversed!\n");
+    return 0;
+}
+
+/// @brief 删除相邻的重复数据，每组相等的数据只保留第一个节点。链表有序时即为去重
+/// @param mylist 指向表头的指针
+/// @return 成功，返回删除的节点个数。失败，返回 -1。
+int unique_link_list(linklist mylist)
+{
+    if (mylist == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    // 墓碑、冻结段和游标不参与比较，先回收墓碑、解冻冻结段、摘下游标
+    LIST_HEAD(dups);
+    LIST_HEAD(front);
+    LIST_HEAD(parked);
+    thaw_link_list(mylist);
+    purge_dead_nodes(&mylist->list, &dups);
+    free_node_list(&dups);
+    park_cursors(&mylist->list, &front, &parked, 0);
+    list_unique(NULL, node_data_cmp, &mylist->list, &dups);
+    unpark_cursors(&mylist->list, &front, &parked, 0);
+
+    int count = free_node_list(&dups);
+    printf("%d duplicate node(s) deleted!\n", count);
+    return count;
+}
+
+/// @brief 从输入读取一条新链表，数据按输入顺序排列
+/// @return 成功，返回指向新表头的指针。失败，返回 NULL。
+linklist read_link_list()
+{
+    int nr = 0;
+
+    printf("Please enter the number of data: ");
+    scanf("%d", &nr);
+    if (nr <= 0)
+    {
+        printf("invalid number!\n");
+        return (linklist)NULL;
+    }
+
+    linklist other = init_list();
+    if (other == (linklist)NULL)
+    {
+        return (linklist)NULL;
+    }
+    printf("Please enter the data in ascending order: ");
+    for (int i = 0; i < nr; i++)
+    {
+        int data = 0;
+        scanf("%d", &data);
+        linklist new = creat_new_node(data);
+        if (new == (linklist)NULL)
+        {
+            free_node_list(&other->list);
+            free(other);
+            return (linklist)NULL;
+        }
+        list_add_tail(&new->list, &other->list);
+    }
+
+    return other;
+}
+
+/// @brief 准备参与有序链表算法：回收墓碑、解冻冻结段、摘下游标，使链表中只剩真正的节点
+/// @param mylist 指向表头的指针
+/// @param front 接收链表开头的游标
+/// @param parked 接收其余游标，算法结束后用 unpark_cursors 按数据放回
+static void prepare_sorted_list(linklist mylist, struct list_head *front, struct list_head *parked)
+{
+    LIST_HEAD(dead);
+
+    thaw_link_list(mylist);
+    purge_dead_nodes(&mylist->list, &dead);
+    free_node_list(&dead);
+    park_cursors(&mylist->list, front, parked, 0);
+}
+
+/// @brief 把另一条有序链表的节点合并进来，保持有序，不新建节点
+/// @param mylist 指向表头的指针，链表需按数据升序排列
+/// @param other 另一条升序链表，合并后为空
+/// @return 成功，返回 0。失败，返回 -1。
+int merge_link_list(linklist mylist, linklist other)
+{
+    if (mylist == (linklist)NULL || other == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    LIST_HEAD(front);
+    LIST_HEAD(parked);
+    prepare_sorted_list(mylist, &front, &parked);
+    list_merge(NULL, node_data_cmp, &mylist->list, &other->list);
+    unpark_cursors(&mylist->list, &front, &parked, 0);
+    printf("Linked lists merged!\n");
+    return 0;
+}
+
+/// @brief 求并集：把另一条有序链表中尚不存在的数据合并进来，重复的节点被释放
+/// @param mylist 指向表头的指针，链表需按数据升序排列且没有重复数据
+/// @param other 另一条升序且没有重复数据的链表，操作后为空
+/// @return 成功，返回释放的重复节点个数。失败，返回 -1。
+int union_link_list(linklist mylist, linklist other)
+{
+    if (mylist == (linklist)NULL || other == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    LIST_HEAD(dups);
+    LIST_HEAD(front);
+    LIST_HEAD(parked);
+    prepare_sorted_list(mylist, &front, &parked);
+    list_union(NULL, node_data_cmp, &mylist->list, &other->list, &dups);
+    unpark_cursors(&mylist->list, &front, &parked, 0);
+
+    int count = free_node_list(&dups);
+    printf("%d duplicate node(s) deleted!\n", count);
+    return count;
+}
+
+/// @brief 求交集：只保留在另一条有序链表中也存在的数据
+/// @param mylist 指向表头的指针，链表需按数据升序排列且没有重复数据
+/// @param other 另一条升序且没有重复数据的链表，操作后为空
+/// @return 成功，返回从 mylist 中删除的节点个数。失败，返回 -1。
+int intersect_link_list(linklist mylist, linklist other)
+{
+    if (mylist == (linklist)NULL || other == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    LIST_HEAD(rest);
+    struct list_head *p;
+    int nr_other = 0;
+    list_for_each(p, &other->list)
+    {
+        nr_other++;
+    }
+    LIST_HEAD(front);
+    LIST_HEAD(parked);
+    prepare_sorted_list(mylist, &front, &parked);
+    list_intersect(NULL, node_data_cmp, &mylist->list, &other->list, &rest);
+    unpark_cursors(&mylist->list, &front, &parked, 0);
+
+    // rest 中除了 other 的全部节点，其余都是从 mylist 中删除的
+    int count = free_node_list(&rest) - nr_other;
+    printf("%d node(s) deleted successfully!\n", count);
+    return count;
+}
+
+/// @brief 求差集：删除在另一条有序链表中存在的数据
+/// @param mylist 指向表头的指针，链表需按数据升序排列且没有重复数据
+/// @param other 另一条升序且没有重复数据的链表，操作后为空
+/// @return 成功，返回从 mylist 中删除的节点个数。失败，返回 -1。
+int difference_link_list(linklist mylist, linklist other)
+{
+    if (mylist == (linklist)NULL || other == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    LIST_HEAD(rest);
+    struct list_head *p;
+    int nr_other = 0;
+    list_for_each(p, &other->list)
+    {
+        nr_other++;
+    }
+    LIST_HEAD(front);
+    LIST_HEAD(parked);
+    prepare_sorted_list(mylist, &front, &parked);
+    list_difference(NULL, node_data_cmp, &mylist->list, &other->list, &rest);
+    unpark_cursors(&mylist->list, &front, &parked, 0);
+
+    // rest 中除了 other 的全部节点，其余都是从 mylist 中删除的
+    int count = free_node_list(&rest) - nr_other;
+    printf("%d node(s) deleted successfully!\n", count);
+    return count;
+}
+
+/// @brief 逻辑删除节点：只打上墓碑标记，不修改相邻节点的指针
+/// @param node 指向节点的指针
+/// @return 成功，返回 0。失败，返回 -1。
+/// @note 节点在下一次 display_linked_list 遍历或 purge_link_list 时被批量摘下并释放。
+int lazy_del_node(linklist node)
+{
+    if (node == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    node->flags |= NODE_DEAD;
+    printf("Node marked as deleted!\n");
+    return 0;
+}
+
+/// @brief 回收所有逻辑删除的节点，一次遍历摘下后统一释放
+/// @param mylist 指向表头的指针
+/// @return 成功，返回回收的节点个数。失败，返回 -1。
+int purge_link_list(linklist mylist)
+{
+    if (mylist == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    LIST_HEAD(dead);
+    purge_dead_nodes(&mylist->list, &dead);
+
+    int count = free_node_list(&dead);
+    printf("%d deleted node(s) purged!\n", count);
+    return count;
+}
+
+/// @brief 设置自动回收的墓碑占比
+/// @param ratio 百分比，0 到 100
+/// @return 成功，返回 0。失败，返回 -1。
+int set_tombstone_ratio(int ratio)
+{
+    if (ratio < 0 || ratio > 100)
+    {
+        printf("invalid ratio!\n");
+        return -1;
+    }
+
+    tombstone_ratio = ratio;
+    return 0;
+}
+
+/// @brief 创建游标。游标是一个不可见的节点，放进链表后被 list_for_each_entry 系列宏跳过
+/// @return 成功，返回指向游标的指针。失败，返回 NULL。
+linklist cursor_create()
+{
+    linklist cursor = creat_new_node(0);
+    if (cursor != (linklist)NULL)
+    {
+        cursor->flags = NODE_CURSOR;
+    }
+
+    return cursor;
+}
+
+/// @brief 把游标放到链表开头，准备开始遍历
+/// @param mylist 指向表头的指针
+/// @param cursor 指向游标的指针
+/// @return 成功，返回 0。失败，返回 -1。
+int cursor_start(linklist mylist, linklist cursor)
+{
+    if (mylist == (linklist)NULL || cursor == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    list_del_init(&cursor->list);
+    list_add(&cursor->list, &mylist->list);
+    return 0;
+}
+
+/// @brief 从游标处继续遍历最多 budget 个节点，再把游标移到最后访问的节点之后
+/// @param cursor 指向游标的指针
+/// @param mylist 指向表头的指针
+/// @param budget 本次最多访问的节点数
+/// @param func 对每个节点调用的函数，返回非 0 时提前结束本次遍历
+/// @param arg 传给 func 的参数
+/// @return 还有节点没有遍历，返回 1。遍历结束，返回 0。失败（包括冻结段解冻失败），返回 -1。
+/// @note 调用者在每次调用期间持有链表的锁，两次调用之间可以释放锁。
+/// 游标是链表中的真实节点，期间其他节点被删除、移动或拼接都不影响它。
+/// reverse_link_list、unique_link_list 和有序集合操作会先摘下游标，完成后放回等价的位置：
+/// 反转后停在相同个数的节点之后，其余操作按数据放在最后一个不大于原前驱数据的节点之后（要求链表有序）。
+/// func 不能摘下或移动节点，需要删除时使用 lazy_del_node。
+int scan_link_list(linklist cursor, linklist mylist, int budget,
+                   int (*func)(linklist node, void *arg), void *arg)
+{
+    if (cursor == (linklist)NULL || mylist == (linklist)NULL || func == NULL || budget <= 0)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+    // 游标不在链表中：还没有开始，或者链表已被摧毁
+    if (list_empty(&cursor->list))
+    {
+        return 0;
+    }
+
+    struct list_head *p;
+    struct list_head *last = &cursor->list;
+    int more = 0;
+
+    for (p = cursor->list.next; p != &mylist->list; p = p->next)
+    {
+        linklist pos = list_entry(p, listnode, list);
+        // func 拿到的必须是真正的节点，遇到冻结段先解冻
+        if (pos->flags & NODE_FROZEN)
+        {
+            struct list_head *prev = thaw_segment((frozenseg *)pos);
+            if (prev == NULL)
+            {
+                // 游标停在冻结段之前，再次调用时从这里重试
+                printf("Failed to thaw frozen nodes!\n");
+                if (last != &cursor->list)
+                {
+                    list_move(&cursor->list, last);
+                }
+                return -1;
+            }
+            p = prev;
+            continue;
+        }
+        if (pos->flags & NODE_HIDDEN)
+        {
+            continue;
+        }
+        if (budget-- == 0)
+        {
+            more = 1;
+            break;
+        }
+        last = &pos->list;
+        if (func(pos, arg))
+        {
+            more = 1;
+            break;
+        }
+    }
+
+    if (!more)
+    {
+        list_del_init(&cursor->list);
+        return 0;
+    }
+    list_move(&cursor->list, last);
+    return 1;
+}
+
+/// @brief 移除并释放游标
+/// @param cursor 指向游标的指针
+/// @return 成功，返回 0。失败，返回 -1。
+int cursor_destroy(linklist cursor)
+{
+    if (cursor == (linklist)NULL)
+    {
+        printf("invalid node!\n");
+        return -1;
+    }
+
+    list_del(&cursor->list);
+    free(cursor);
+    return 0;
+}
+
 /// @brief 摧毁链表
 /// @param mylist 指向表头的指针
 /// @return 成功，返回 0。失败，返回 -1。
@@ -348,13 +1831,8 @@ int destroy_link_list(linklist mylist)
     }
     else
     {
-        struct list_head *pos, *q;
-        list_for_each_safe(pos, q, &mylist->list)
-        {
-            linklist tmp = list_entry(pos, listnode, list);
-            list_del(pos);
-            free(tmp);
-        }
+        // 整条链表都要丢弃，不需要逐个 list_del 修改相邻节点的指针
+        free_node_list(&mylist->list);
         // free(mylist);
         printf("Successfully destroyed the linked list!\n");
         return 0;
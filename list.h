@@ -23,7 +23,9 @@
  */
 
 // 计算member在type中的位置
+#ifndef offsetof
 #define offsetof(TYPE, MEMBER) ((size_t) & ((TYPE *)0)->MEMBER)
+#endif
 /**
  * @brief container_of - cast a member of a structure out to the containing structure (根据member的地址获取type的起始地址)
  * @param ptr	the pointer to the member.
@@ -77,6 +79,19 @@ static inline bool __list_del_entry_valid(struct list_head *entry)
 }
 #endif
 
+/*
+ * list_entry_hidden(pos, member) - whether the list_for_each_entry* iterators
+ * skip [ pos ]. It is never true by default, so the check compiles away.
+ * A user that keeps invisible entries in its lists (tombstones, cursors, ...)
+ * defines it before including this file, e.g.
+ *	#define list_entry_hidden(pos, member) ((pos)->flags != 0)
+ * Every entry type walked with these iterators in that file must then
+ * understand the expression. list_for_each() and friends never skip anything.
+ */
+#ifndef list_entry_hidden
+#define list_entry_hidden(pos, member) 0
+#endif
+
 /*
  * Insert a new entry between two known consecutive entries.
  *
@@ -461,7 +476,8 @@ static inline void list_splice_tail_init(struct list_head *list,
 #define list_for_each_entry(pos, head, member)               \
 	for (pos = list_first_entry(head, typeof(*pos), member); \
 		 &pos->member != (head);                             \
-		 pos = list_next_entry(pos, member))
+		 pos = list_next_entry(pos, member))                 \
+		if (list_entry_hidden(pos, member)) {} else
 
 /**
  * @brief list_for_each_entry_reverse - iterate backwards over list of given type.
@@ -472,7 +488,8 @@ static inline void list_splice_tail_init(struct list_head *list,
 #define list_for_each_entry_reverse(pos, head, member)      \
 	for (pos = list_last_entry(head, typeof(*pos), member); \
 		 &pos->member != (head);                            \
-		 pos = list_prev_entry(pos, member))
+		 pos = list_prev_entry(pos, member))                \
+		if (list_entry_hidden(pos, member)) {} else
 
 /**
  * @brief list_prepare_entry - prepare a pos entry for use in list_for_each_entry_continue()
@@ -497,7 +514,8 @@ static inline void list_splice_tail_init(struct list_head *list,
 #define list_for_each_entry_continue(pos, head, member) \
 	for (pos = list_next_entry(pos, member);            \
 		 &pos->member != (head);                        \
-		 pos = list_next_entry(pos, member))
+		 pos = list_next_entry(pos, member))            \
+		if (list_entry_hidden(pos, member)) {} else
 
 /**
  * @brief list_for_each_entry_continue_reverse - iterate backwards from the given point
@@ -511,7 +529,8 @@ static inline void list_splice_tail_init(struct list_head *list,
 #define list_for_each_entry_continue_reverse(pos, head, member) \
 	for (pos = list_prev_entry(pos, member);                    \
 		 &pos->member != (head);                                \
-		 pos = list_prev_entry(pos, member))
+		 pos = list_prev_entry(pos, member))                    \
+		if (list_entry_hidden(pos, member)) {} else
 
 /**
  * @brief list_for_each_entry_from - iterate over list of given type from the current point
@@ -523,7 +542,8 @@ static inline void list_splice_tail_init(struct list_head *list,
  */
 #define list_for_each_entry_from(pos, head, member) \
 	for (; &pos->member != (head);                  \
-		 pos = list_next_entry(pos, member))
+		 pos = list_next_entry(pos, member))        \
+		if (list_entry_hidden(pos, member)) {} else
 
 /**
  * @brief list_for_each_entry_safe - iterate over list of given type safe against removal of list entry
@@ -536,7 +556,8 @@ static inline void list_splice_tail_init(struct list_head *list,
 	for (pos = list_first_entry(head, typeof(*pos), member), \
 		n = list_next_entry(pos, member);                    \
 		 &pos->member != (head);                             \
-		 pos = n, n = list_next_entry(n, member))
+		 pos = n, n = list_next_entry(n, member))            \
+		if (list_entry_hidden(pos, member)) {} else
 
 /**
  * @brief list_for_each_entry_safe_continue - continue list iteration safe against removal
@@ -552,7 +573,8 @@ static inline void list_splice_tail_init(struct list_head *list,
 	for (pos = list_next_entry(pos, member),                    \
 		n = list_next_entry(pos, member);                       \
 		 &pos->member != (head);                                \
-		 pos = n, n = list_next_entry(n, member))
+		 pos = n, n = list_next_entry(n, member))               \
+		if (list_entry_hidden(pos, member)) {} else
 
 /**
  * @brief list_for_each_entry_safe_from - iterate over list from current point safe against removal
@@ -567,7 +589,8 @@ static inline void list_splice_tail_init(struct list_head *list,
 #define list_for_each_entry_safe_from(pos, n, head, member) \
 	for (n = list_next_entry(pos, member);                  \
 		 &pos->member != (head);                            \
-		 pos = n, n = list_next_entry(n, member))
+		 pos = n, n = list_next_entry(n, member))           \
+		if (list_entry_hidden(pos, member)) {} else
 
 /**
  * @brief list_for_each_entry_safe_reverse - iterate backwards over list safe against removal
@@ -583,7 +606,8 @@ static inline void list_splice_tail_init(struct list_head *list,
 	for (pos = list_last_entry(head, typeof(*pos), member),    \
 		n = list_prev_entry(pos, member);                      \
 		 &pos->member != (head);                               \
-		 pos = n, n = list_prev_entry(n, member))
+		 pos = n, n = list_prev_entry(n, member))              \
+		if (list_entry_hidden(pos, member)) {} else
 
 /**
  * @brief list_safe_reset_next - reset a stale list_for_each_entry_safe loop
@@ -599,4 +623,28 @@ static inline void list_splice_tail_init(struct list_head *list,
  */
 #define list_safe_reset_next(pos, n, member) \
 	n = list_next_entry(pos, member)
+
+/**
+ * @brief list_partition - move every entry matching a condition to another list
+ * @param pos	the type * to use as a loop cursor.
+ * @param n		another type * to use as temporary storage
+ * @param head	the head for your list.
+ * @param list	the list to move the matching entries to, at its tail.
+ * @param member	the name of the list_head within the struct.
+ * @param cond	an expression of [ pos ], entries for which it is true are moved.
+ *
+ * @note One pass over [ head ], safe against the removal done by itself.
+ * The matching entries keep their relative order on [ list ], so the caller
+ * can free them in one go or splice them somewhere else.
+ * Entries hidden by list_entry_hidden() are never moved.
+ */
+#define list_partition(pos, n, head, list, member, cond)     \
+	do                                                       \
+	{                                                        \
+		list_for_each_entry_safe(pos, n, head, member)       \
+		{                                                    \
+			if (cond)                                        \
+				list_move_tail(&(pos)->member, (list));      \
+		}                                                    \
+	} while (0)
 #endif
@@ -0,0 +1,209 @@
+#ifndef _LIST_ALGO_H
+#define _LIST_ALGO_H
+
+// 有序链表的线性时间算法：合并、去重、并集、交集、差集，以及原地反转。
+// 所有算法只修改节点的指针，不分配也不释放内存。
+// 被剔除的节点会移动到调用者提供的链表中，由调用者决定释放还是另作他用。
+
+#include "list.h"
+
+/*
+ * cmp(priv, a, b) returns < 0 if a sorts before b, 0 if they are equal and
+ * > 0 if a sorts after b, the same convention as list_sort() in the kernel.
+ */
+typedef int (*list_cmp_func_t)(void *priv, struct list_head *a, struct list_head *b);
+
+/*
+ * Move the entries from [ first ] up to the last entry of [ head ] to the
+ * tail of [ list ]. [ first ] must be on [ head ], or be [ head ] itself in
+ * which case nothing is moved.
+ */
+static inline void __list_splice_suffix(struct list_head *head,
+										struct list_head *first,
+										struct list_head *list)
+{
+	struct list_head *last = head->prev;
+
+	if (first == head)
+		return;
+
+	first->prev->next = head;
+	head->prev = first->prev;
+
+	first->prev = list->prev;
+	list->prev->next = first;
+	last->next = list;
+	list->prev = last;
+}
+
+/// @brief list_merge - merge a sorted list into another sorted list
+/// @param priv private data, passed to [ cmp ]
+/// @param cmp the elements comparison function
+/// @param head the sorted list to merge into
+/// @param list the sorted list to take the entries from, left empty
+/// @note Stable: on ties the entries already on [ head ] come first. O(n + m).
+static inline void list_merge(void *priv, list_cmp_func_t cmp,
+							  struct list_head *head, struct list_head *list)
+{
+	struct list_head *pos = head->next;
+	struct list_head *entry;
+
+	while (!list_empty(list))
+	{
+		entry = list->next;
+		while (pos != head && cmp(priv, pos, entry) <= 0)
+			pos = pos->next;
+		if (pos == head)
+		{
+			list_splice_tail_init(list, head);
+			break;
+		}
+		list_move_tail(entry, pos);
+	}
+}
+
+/// @brief list_unique - remove consecutive duplicate entries from a sorted list
+/// @param priv private data, passed to [ cmp ]
+/// @param cmp the elements comparison function
+/// @param head the sorted list
+/// @param dups the list to move the duplicates to, at its tail
+/// @return the number of entries moved to [ dups ]
+/// @note The first entry of every run of equal entries is kept.
+static inline int list_unique(void *priv, list_cmp_func_t cmp,
+							  struct list_head *head, struct list_head *dups)
+{
+	struct list_head *pos;
+	int count = 0;
+
+	list_for_each(pos, head)
+	{
+		while (pos->next != head && cmp(priv, pos, pos->next) == 0)
+		{
+			list_move_tail(pos->next, dups);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/// @brief list_union - merge two sorted sets, keeping one entry per value
+/// @param priv private data, passed to [ cmp ]
+/// @param cmp the elements comparison function
+/// @param head the sorted set that receives the union
+/// @param list the sorted set to take the entries from, left empty
+/// @param dups the list to move the entries of [ list ] already present on [ head ] to
+/// @note Both lists are expected to be free of duplicates, run list_unique() first otherwise.
+static inline void list_union(void *priv, list_cmp_func_t cmp,
+							  struct list_head *head, struct list_head *list,
+							  struct list_head *dups)
+{
+	struct list_head *pos = head->next;
+	struct list_head *entry;
+	int c = 1;
+
+	while (!list_empty(list))
+	{
+		entry = list->next;
+		while (pos != head && (c = cmp(priv, pos, entry)) < 0)
+			pos = pos->next;
+		if (pos == head)
+		{
+			list_splice_tail_init(list, head);
+			break;
+		}
+		if (c == 0)
+			list_move_tail(entry, dups);
+		else
+			list_move_tail(entry, pos);
+	}
+}
+
+/// @brief list_intersect - keep only the entries of a sorted set that are also in another
+/// @param priv private data, passed to [ cmp ]
+/// @param cmp the elements comparison function
+/// @param head the sorted set that receives the intersection
+/// @param list the other sorted set, left empty
+/// @param rest the list to move every dropped entry of [ head ] and all of [ list ] to
+static inline void list_intersect(void *priv, list_cmp_func_t cmp,
+								  struct list_head *head, struct list_head *list,
+								  struct list_head *rest)
+{
+	struct list_head *a = head->next;
+	struct list_head *b = list->next;
+	struct list_head *next;
+	int c;
+
+	while (a != head && b != list)
+	{
+		c = cmp(priv, a, b);
+		if (c < 0)
+		{
+			next = a->next;
+			list_move_tail(a, rest);
+			a = next;
+		}
+		else
+		{
+			if (c == 0)
+				a = a->next;
+			b = b->next;
+		}
+	}
+	__list_splice_suffix(head, a, rest);
+	list_splice_tail_init(list, rest);
+}
+
+/// @brief list_difference - remove from a sorted set the entries present in another
+/// @param priv private data, passed to [ cmp ]
+/// @param cmp the elements comparison function
+/// @param head the sorted set that receives the difference
+/// @param list the sorted set to subtract, left empty
+/// @param rest the list to move every dropped entry of [ head ] and all of [ list ] to
+static inline void list_difference(void *priv, list_cmp_func_t cmp,
+								   struct list_head *head, struct list_head *list,
+								   struct list_head *rest)
+{
+	struct list_head *a = head->next;
+	struct list_head *b = list->next;
+	struct list_head *next;
+	int c;
+
+	while (a != head && b != list)
+	{
+		c = cmp(priv, a, b);
+		if (c < 0)
+		{
+			a = a->next;
+		}
+		else
+		{
+			if (c == 0)
+			{
+				next = a->next;
+				list_move_tail(a, rest);
+				a = next;
+			}
+			b = b->next;
+		}
+	}
+	list_splice_tail_init(list, rest);
+}
+
+/// @brief list_reverse - reverse the order of a list in place
+/// @param head the list to reverse
+static inline void list_reverse(struct list_head *head)
+{
+	struct list_head *pos = head;
+	struct list_head *tmp;
+
+	do
+	{
+		tmp = pos->next;
+		pos->next = pos->prev;
+		pos->prev = tmp;
+		pos = tmp;
+	} while (pos != head);
+}
+
+#endif
@@ -0,0 +1,387 @@
+// list_algo.h 有序链表算法与逐个插入方式的对比测试
+// 编译：gcc -O2 -o list_algo_bench list_algo_bench.c
+// 用法：./list_algo_bench [-j] [-m 最大节点数] [-r 重复次数]
+//   -j  输出 JSON，默认输出 CSV
+// 逐个插入方式即 kernel_link_list.c 中的做法：每个数据先从表头遍历找到位置，
+// 再像 insert_node_anywhere 一样新建节点并 list_add 到目标节点之后，原节点释放；
+// 判断数据是否存在则像 find_node 一样从表头遍历。
+// 两条输入链表各约 n 个节点，数据有一半左右重合。两种方式的结果先比对一致，再输出耗时和加速比。
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "list.h"
+#include "list_algo.h"
+
+typedef struct node
+{
+    int data;
+    struct list_head list;
+} listnode, *linklist;
+
+enum
+{
+    OP_MERGE,
+    OP_UNIQUE,
+    OP_UNION,
+    OP_INTERSECT,
+    OP_DIFFERENCE,
+    NR_OPS,
+};
+
+static const char *op_name[NR_OPS] = {"merge", "unique", "union", "intersect", "difference"};
+
+/// @brief 获取单调时钟，单位纳秒
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/// @brief 按数据比较两个节点
+static int node_cmp(void *priv, struct list_head *a, struct list_head *b)
+{
+    int x = list_entry(a, listnode, list)->data;
+    int y = list_entry(b, listnode, list)->data;
+
+    return (x > y) - (x < y);
+}
+
+/// @brief 创建新节点
+static linklist new_node(int data)
+{
+    linklist node = (linklist)malloc(sizeof(listnode));
+    if (node == NULL)
+    {
+        perror("malloc");
+        exit(-1);
+    }
+    node->data = data;
+    INIT_LIST_HEAD(&node->list);
+
+    return node;
+}
+
+/// @brief 释放链表中的所有节点
+static void free_list(struct list_head *head)
+{
+    struct list_head *pos, *n;
+
+    list_for_each_safe(pos, n, head)
+    {
+        free(list_entry(pos, listnode, list));
+    }
+    INIT_LIST_HEAD(head);
+}
+
+/// @brief 生成有序数据，[0, 2n) 中每个数以 1/2 的概率出现，dup 为真时有 1/4 的数出现两次
+/// @return 生成的数据个数
+static size_t gen_sorted(int *values, size_t n, int dup, unsigned int *seed)
+{
+    size_t nr = 0;
+
+    for (size_t v = 0; v < 2 * n; v++)
+    {
+        if (rand_r(seed) & 1)
+        {
+            values[nr++] = (int)v;
+            if (dup && (rand_r(seed) & 3) == 0)
+            {
+                values[nr++] = (int)v;
+            }
+        }
+    }
+
+    return nr;
+}
+
+/// @brief 用数据建链表
+static void build_list(struct list_head *head, const int *values, size_t nr)
+{
+    INIT_LIST_HEAD(head);
+    for (size_t i = 0; i < nr; i++)
+    {
+        list_add_tail(&new_node(values[i])->list, head);
+    }
+}
+
+/// @brief 像 find_node 一样从表头查找数据
+static linklist find_by_scan(struct list_head *head, int data)
+{
+    linklist pos;
+
+    list_for_each_entry(pos, head, list)
+    {
+        if (pos->data == data)
+        {
+            return pos;
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief 从表头找到最后一个不大于 data 的节点，没有时返回表头
+/// @param equal 是否已存在相等的数据
+static struct list_head *find_insert_pos(struct list_head *head, int data, int *equal)
+{
+    struct list_head *dest = head;
+    linklist pos;
+
+    *equal = 0;
+    list_for_each_entry(pos, head, list)
+    {
+        if (pos->data > data)
+        {
+            break;
+        }
+        *equal = pos->data == data;
+        dest = &pos->list;
+    }
+
+    return dest;
+}
+
+/// @brief 逐个插入方式：把 list 的节点一个个插入 head，skip_equal 为真时跳过已存在的数据
+static void insert_one_by_one(struct list_head *head, struct list_head *list, int skip_equal)
+{
+    struct list_head *pos, *n;
+    int equal;
+
+    list_for_each_safe(pos, n, list)
+    {
+        linklist src = list_entry(pos, listnode, list);
+        struct list_head *dest = find_insert_pos(head, src->data, &equal);
+        if (!(skip_equal && equal))
+        {
+            // 与 insert_node_anywhere 相同：新建节点插在目标节点之后
+            list_add(&new_node(src->data)->list, dest);
+        }
+        list_del(pos);
+        free(src);
+    }
+}
+
+/// @brief 逐个插入方式：删除 head 中在 list 里存在（keep 为 0）或不存在（keep 为 1）的数据
+static void delete_one_by_one(struct list_head *head, struct list_head *list, int keep)
+{
+    struct list_head *pos, *n;
+
+    list_for_each_safe(pos, n, head)
+    {
+        linklist node = list_entry(pos, listnode, list);
+        if ((find_by_scan(list, node->data) != NULL) != keep)
+        {
+            list_del(pos);
+            free(node);
+        }
+    }
+    free_list(list);
+}
+
+/// @brief 执行一次测试
+/// @param op 操作
+/// @param algo 为真时用 list_algo.h，否则用逐个插入方式
+/// @param result 结果链表，由调用者释放
+/// @return 耗时（纳秒）
+static double run_op(int op, int algo, const int *a, size_t na, const int *b, size_t nb,
+                     struct list_head *result)
+{
+    LIST_HEAD(list);
+    LIST_HEAD(rest);
+    double start, end;
+
+    build_list(result, a, na);
+    build_list(&list, b, nb);
+
+    start = now_ns();
+    switch (op)
+    {
+    case OP_MERGE:
+        if (algo)
+        {
+            list_merge(NULL, node_cmp, result, &list);
+        }
+        else
+        {
+            insert_one_by_one(result, &list, 0);
+        }
+        break;
+    case OP_UNIQUE:
+        // 合并两条有重复数据的链表后去重
+        if (algo)
+        {
+            list_merge(NULL, node_cmp, result, &list);
+            list_unique(NULL, node_cmp, result, &rest);
+        }
+        else
+        {
+            LIST_HEAD(all);
+            list_splice_init(result, &all);
+            list_splice_tail_init(&list, &all);
+            insert_one_by_one(result, &all, 1);
+        }
+        break;
+    case OP_UNION:
+        if (algo)
+        {
+            list_union(NULL, node_cmp, result, &list, &rest);
+        }
+        else
+        {
+            insert_one_by_one(result, &list, 1);
+        }
+        break;
+    case OP_INTERSECT:
+        if (algo)
+        {
+            list_intersect(NULL, node_cmp, result, &list, &rest);
+        }
+        else
+        {
+            delete_one_by_one(result, &list, 1);
+        }
+        break;
+    case OP_DIFFERENCE:
+        if (algo)
+        {
+            list_difference(NULL, node_cmp, result, &list, &rest);
+        }
+        else
+        {
+            delete_one_by_one(result, &list, 0);
+        }
+        break;
+    }
+    free_list(&rest);
+    end = now_ns();
+
+    return end - start;
+}
+
+/// @brief 比较两条链表的数据是否完全相同
+static int same_list(struct list_head *x, struct list_head *y)
+{
+    struct list_head *p = x->next, *q = y->next;
+
+    while (p != x && q != y)
+    {
+        if (list_entry(p, listnode, list)->data != list_entry(q, listnode, list)->data)
+        {
+            return 0;
+        }
+        p = p->next;
+        q = q->next;
+    }
+
+    return p == x && q == y;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_nodes = 16384;
+    int reps = 3;
+    int json_output = 0;
+    int first_record = 1;
+    unsigned int seed = 12345;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "jm:r:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            json_output = 1;
+            break;
+        case 'm':
+            max_nodes = strtoull(optarg, NULL, 0);
+            break;
+        case 'r':
+            reps = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j] [-m max_nodes] [-r reps]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (reps <= 0)
+    {
+        reps = 1;
+    }
+
+    if (json_output)
+    {
+        printf("[\n");
+    }
+    else
+    {
+        printf("op,nodes,list_algo_ms,node_by_node_ms,speedup\n");
+    }
+
+    for (size_t n = 1024; n <= max_nodes; n *= 2)
+    {
+        // 最多 2n 个数，每个最多出现两次
+        int *a = (int *)malloc(sizeof(int) * 4 * n);
+        int *b = (int *)malloc(sizeof(int) * 4 * n);
+        if (a == NULL || b == NULL)
+        {
+            perror("malloc");
+            free(a);
+            free(b);
+            return -1;
+        }
+
+        for (int op = 0; op < NR_OPS; op++)
+        {
+            int dup = op == OP_MERGE || op == OP_UNIQUE;
+            size_t na = gen_sorted(a, n, dup, &seed);
+            size_t nb = gen_sorted(b, n, dup, &seed);
+            double best[2] = {-1, -1};
+
+            for (int r = 0; r < reps; r++)
+            {
+                LIST_HEAD(x);
+                LIST_HEAD(y);
+                double t0 = run_op(op, 1, a, na, b, nb, &x);
+                double t1 = run_op(op, 0, a, na, b, nb, &y);
+                if (!same_list(&x, &y))
+                {
+                    fprintf(stderr, "%s: results differ at %zu nodes\n", op_name[op], n);
+                    return -1;
+                }
+                free_list(&x);
+                free_list(&y);
+                best[0] = (best[0] < 0 || t0 < best[0]) ? t0 : best[0];
+                best[1] = (best[1] < 0 || t1 < best[1]) ? t1 : best[1];
+            }
+
+            if (json_output)
+            {
+                printf("%s  {\"op\": \"%s\", \"nodes\": %zu, \"list_algo_ms\": %.3f, "
+                       "\"node_by_node_ms\": %.3f, \"speedup\": %.1f}",
+                       first_record ? "" : ",\n", op_name[op], n, best[0] / 1e6, best[1] / 1e6,
+                       best[1] / best[0]);
+            }
+            else
+            {
+                printf("%s,%zu,%.3f,%.3f,%.1f\n", op_name[op], n, best[0] / 1e6, best[1] / 1e6,
+                       best[1] / best[0]);
+            }
+            first_record = 0;
+            fflush(stdout);
+        }
+
+        free(a);
+        free(b);
+    }
+
+    if (json_output)
+    {
+        printf("\n]\n");
+    }
+
+    return 0;
+}
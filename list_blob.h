@@ -0,0 +1,276 @@
+#ifndef _LIST_BLOB_H
+#define _LIST_BLOB_H
+
+// 变长数据节点
+// 数据直接放在节点的柔性数组成员里，紧跟在 struct list_head 后面，
+// 访问数据不需要再跳一次指针，一个节点也只需要一次分配。
+// 节点按大小分级，从对应级别的内存池中分配；释放的节点通过自身的 list 挂到空闲链表上复用。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+
+#define BLOB_CHUNK_SIZE (64 * 1024) // 内存池每次向系统申请的大小
+#define BLOB_LARGE 0xffff           // 超过最大级别的节点直接 malloc
+
+// 各级节点的总大小（含节点头），都是 16 的倍数
+static const unsigned int blob_class_size[] = {
+    32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096,
+};
+#define BLOB_NR_CLASSES (int)(sizeof(blob_class_size) / sizeof(blob_class_size[0]))
+
+// 变长数据节点
+typedef struct blobnode
+{
+    struct list_head list;
+    unsigned int len;       // 数据长度
+    unsigned short cls;     // 所属级别，BLOB_LARGE 表示单独 malloc
+    unsigned char data[];   // 数据
+} blobnode, *bloblist;
+
+// 内存池中的一大块内存
+struct blob_chunk
+{
+    struct list_head list;
+    size_t used; // 已切出去的字节数
+    int cls;     // 这块内存切给哪一级
+    unsigned char mem[] __attribute__((aligned(16)));
+};
+
+// 分级内存池
+struct blob_arena
+{
+    struct list_head free[BLOB_NR_CLASSES];     // 各级的空闲节点
+    struct blob_chunk *current[BLOB_NR_CLASSES]; // 各级正在切分的内存块
+    struct list_head chunks;                     // 所有内存块，销毁时释放
+    size_t nr_chunks;
+};
+
+/// @brief 初始化内存池
+/// @param arena 指向内存池的指针
+static inline void blob_arena_init(struct blob_arena *arena)
+{
+    for (int i = 0; i < BLOB_NR_CLASSES; i++)
+    {
+        INIT_LIST_HEAD(&arena->free[i]);
+        arena->current[i] = NULL;
+    }
+    INIT_LIST_HEAD(&arena->chunks);
+    arena->nr_chunks = 0;
+}
+
+/// @brief 释放内存池的所有内存块。之前分配的非 BLOB_LARGE 节点随之失效
+/// @param arena 指向内存池的指针
+static inline void blob_arena_destroy(struct blob_arena *arena)
+{
+    struct list_head *pos, *q;
+
+    list_for_each_safe(pos, q, &arena->chunks)
+    {
+        free(list_entry(pos, struct blob_chunk, list));
+    }
+    blob_arena_init(arena);
+}
+
+/// @brief 计算数据长度对应的级别
+/// @param len 数据长度
+/// @return 级别，超过最大级别返回 BLOB_LARGE
+static inline int blob_size_class(size_t len)
+{
+    size_t size = sizeof(blobnode) + len;
+
+    for (int i = 0; i < BLOB_NR_CLASSES; i++)
+    {
+        if (size <= blob_class_size[i])
+        {
+            return i;
+        }
+    }
+
+    return BLOB_LARGE;
+}
+
+/// @brief 从内存池中取一个指定级别的节点
+/// @param arena 指向内存池的指针
+/// @param cls 级别
+/// @return 成功，返回指向节点的指针。失败，返回 NULL。
+static inline bloblist __blob_take(struct blob_arena *arena, int cls)
+{
+    struct blob_chunk *chunk = arena->current[cls];
+    unsigned int size = blob_class_size[cls];
+    bloblist node;
+
+    if (!list_empty(&arena->free[cls]))
+    {
+        node = list_first_entry(&arena->free[cls], blobnode, list);
+        list_del(&node->list);
+        return node;
+    }
+
+    if (chunk == NULL || chunk->used + size > BLOB_CHUNK_SIZE - sizeof(struct blob_chunk))
+    {
+        chunk = (struct blob_chunk *)malloc(BLOB_CHUNK_SIZE);
+        if (chunk == NULL)
+        {
+            perror("malloc");
+            return NULL;
+        }
+        chunk->used = 0;
+        chunk->cls = cls;
+        list_add(&chunk->list, &arena->chunks);
+        arena->current[cls] = chunk;
+        arena->nr_chunks++;
+    }
+    node = (bloblist)(chunk->mem + chunk->used);
+    chunk->used += size;
+
+    return node;
+}
+
+/// @brief 创建一个变长数据节点
+/// @param arena 指向内存池的指针
+/// @param data 数据
+/// @param len 数据长度
+/// @return 成功，返回指向新节点的指针。失败，返回 NULL。
+static inline bloblist blob_new_node(struct blob_arena *arena, const void *data, size_t len)
+{
+    int cls = blob_size_class(len);
+    bloblist node;
+
+    if (cls == BLOB_LARGE)
+    {
+        node = (bloblist)malloc(sizeof(blobnode) + len);
+        if (node == NULL)
+        {
+            perror("malloc");
+            return NULL;
+        }
+    }
+    else
+    {
+        node = __blob_take(arena, cls);
+        if (node == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    INIT_LIST_HEAD(&node->list);
+    node->len = (unsigned int)len;
+    node->cls = (unsigned short)cls;
+    memcpy(node->data, data, len);
+
+    return node;
+}
+
+/// @brief 释放节点，节点必须已经不在任何链表中
+/// @param arena 指向内存池的指针
+/// @param node 指向节点的指针
+static inline void blob_free_node(struct blob_arena *arena, bloblist node)
+{
+    if (node->cls == BLOB_LARGE)
+    {
+        free(node);
+    }
+    else
+    {
+        list_add(&node->list, &arena->free[node->cls]);
+    }
+}
+
+/// @brief 从表头插入数据
+/// @param arena 指向内存池的指针
+/// @param head 指向表头的指针
+/// @param data 数据
+/// @param len 数据长度
+/// @return 成功，返回指向新节点的指针。失败，返回 NULL。
+static inline bloblist blob_add(struct blob_arena *arena, struct list_head *head,
+                                const void *data, size_t len)
+{
+    bloblist node = blob_new_node(arena, data, len);
+    if (node != NULL)
+    {
+        list_add(&node->list, head);
+    }
+
+    return node;
+}
+
+/// @brief 从表尾插入数据
+/// @param arena 指向内存池的指针
+/// @param head 指向表头的指针
+/// @param data 数据
+/// @param len 数据长度
+/// @return 成功，返回指向新节点的指针。失败，返回 NULL。
+static inline bloblist blob_add_tail(struct blob_arena *arena, struct list_head *head,
+                                     const void *data, size_t len)
+{
+    bloblist node = blob_new_node(arena, data, len);
+    if (node != NULL)
+    {
+        list_add_tail(&node->list, head);
+    }
+
+    return node;
+}
+
+/// @brief 查找包含指定数据的节点
+/// @param head 指向表头的指针
+/// @param data 数据
+/// @param len 数据长度
+/// @return 成功，返回指向第一个匹配节点的指针。失败，返回 NULL。
+static inline bloblist blob_find(struct list_head *head, const void *data, size_t len)
+{
+    struct list_head *pos;
+
+    // 用 list_for_each，不受 list_entry_hidden 影响
+    list_for_each(pos, head)
+    {
+        bloblist node = list_entry(pos, blobnode, list);
+        if (node->len == len && memcmp(node->data, data, len) == 0)
+        {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief 删除节点
+/// @param arena 指向内存池的指针
+/// @param node 指向节点的指针
+/// @return 成功，返回 0。失败，返回 -1。
+static inline int blob_del(struct blob_arena *arena, bloblist node)
+{
+    if (node == NULL)
+    {
+        return -1;
+    }
+
+    list_del(&node->list);
+    blob_free_node(arena, node);
+    return 0;
+}
+
+/// @brief 删除链表中的所有节点
+/// @param arena 指向内存池的指针
+/// @param head 指向表头的指针
+/// @return 删除的节点个数
+static inline int blob_destroy_list(struct blob_arena *arena, struct list_head *head)
+{
+    struct list_head *pos, *q;
+    int count = 0;
+
+    list_for_each_safe(pos, q, head)
+    {
+        blob_free_node(arena, list_entry(pos, blobnode, list));
+        count++;
+    }
+    INIT_LIST_HEAD(head);
+
+    return count;
+}
+
+#endif
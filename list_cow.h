@@ -0,0 +1,444 @@
+#ifndef _LIST_COW_H
+#define _LIST_COW_H
+
+// 支持一致性快照的多版本链表
+// 每次修改都会产生一个新版本。节点记录自己在哪个版本出现（birth）、在哪个版本被删除（death），
+// 读者调用 cow_list_snapshot 在 O(1) 时间内拿到当前版本号，遍历时只看该版本可见的节点，
+// 不需要加锁，写者可以同时继续修改链表。
+// 未被修改的节点在各版本之间共享；移动或修改节点时，旧节点在新版本中被删除，新的副本在新版本中出现。
+// 被删除的节点在没有快照还能看到它之后才从链表中摘下，在没有读者还可能停留在它上面之后才释放。
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "list.h"
+
+#define COW_MAX_READERS 64  // 最多同时存在的快照数
+#define COW_ALIVE ULONG_MAX // death 为该值表示节点没有被删除
+
+// 多版本节点，使用时内嵌到自己的结构体中
+struct cow_entry
+{
+    struct list_head list;
+    unsigned long birth;           // 从这个版本开始可见
+    unsigned long death;           // 从这个版本开始不可见
+    unsigned long retire;          // 从链表中摘下时的版本
+    struct cow_entry *retire_next; // 等待释放的节点链，不能复用 list，读者可能还在用它的 next
+};
+
+// 多版本链表
+struct cow_list
+{
+    struct list_head head;
+    pthread_mutex_t lock;                       // 串行化写者
+    atomic_ulong version;                       // 当前版本，从 1 开始
+    atomic_ulong readers[COW_MAX_READERS];      // 各快照的版本，0 表示空闲
+    struct cow_entry *retired;                  // 已摘下、等待释放的节点
+    long nr_live;                               // 当前版本可见的节点数
+    long nr_dead;                               // 已删除但还在链表中的节点数
+    unsigned long min_death;                    // 已删除但还在链表中的节点里最小的 death，没有时为 COW_ALIVE
+    unsigned long min_retire;                   // retired 中最小的 retire，没有时为 COW_ALIVE
+    void (*release)(struct cow_entry *entry);   // 释放节点的回调
+};
+
+// 快照
+struct cow_snapshot
+{
+    struct cow_list *cl;
+    unsigned long version;
+    int slot;
+};
+
+/// @brief 初始化
+/// @param cl 指向多版本链表的指针
+/// @param release 释放节点的回调
+static inline void cow_list_init(struct cow_list *cl, void (*release)(struct cow_entry *entry))
+{
+    INIT_LIST_HEAD(&cl->head);
+    pthread_mutex_init(&cl->lock, NULL);
+    atomic_init(&cl->version, 1);
+    for (int i = 0; i < COW_MAX_READERS; i++)
+    {
+        atomic_init(&cl->readers[i], 0);
+    }
+    cl->retired = NULL;
+    cl->nr_live = 0;
+    cl->nr_dead = 0;
+    cl->min_death = COW_ALIVE;
+    cl->min_retire = COW_ALIVE;
+    cl->release = release;
+}
+
+/// @brief 读者读取下一个节点指针
+static inline struct list_head *__cow_load_next(struct list_head *p)
+{
+    return __atomic_load_n(&p->next, __ATOMIC_ACQUIRE);
+}
+
+/// @brief 写者把 new 发布到 prev 和 next 之间，读者要么看不到它，要么看到完整的节点
+static inline void __cow_link(struct list_head *new, struct list_head *prev, struct list_head *next)
+{
+    new->next = next;
+    new->prev = prev;
+    next->prev = new;
+    __atomic_store_n(&prev->next, new, __ATOMIC_RELEASE);
+}
+
+/// @brief 写者把节点从链表中摘下，保留它的 next，停留在它上面的读者还能继续往后走
+static inline void __cow_unlink(struct list_head *entry)
+{
+    entry->next->prev = entry->prev;
+    __atomic_store_n(&entry->prev->next, entry->next, __ATOMIC_RELEASE);
+}
+
+/// @brief 节点在指定版本中是否可见
+static inline int __cow_visible(struct cow_entry *e, unsigned long version)
+{
+    return __atomic_load_n(&e->birth, __ATOMIC_ACQUIRE) <= version &&
+           version < __atomic_load_n(&e->death, __ATOMIC_ACQUIRE);
+}
+
+/// @brief 从 from 往后找快照中下一个可见的节点
+/// @param from 开始的位置，不包括它自己
+/// @param snap 指向快照的指针
+/// @return 找到，返回指向节点的指针。到达表尾，返回 NULL。
+static inline struct cow_entry *__cow_next(struct list_head *from, struct cow_snapshot *snap)
+{
+    struct list_head *p = __cow_load_next(from);
+
+    while (p != &snap->cl->head)
+    {
+        struct cow_entry *e = list_entry(p, struct cow_entry, list);
+        if (__cow_visible(e, snap->version))
+        {
+            return e;
+        }
+        p = __cow_load_next(p);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief cow_for_each_entry - 遍历快照中可见的节点
+ * @param pos	外层结构的指针，用作循环游标
+ * @param snap	指向快照的指针
+ * @param member	struct cow_entry 在外层结构中的名字
+ */
+#define cow_for_each_entry(pos, snap, member)                                       \
+    for (struct cow_entry *__cow_e = __cow_next(&(snap)->cl->head, (snap));         \
+         __cow_e != NULL && ((pos) = container_of(__cow_e, typeof(*(pos)), member), 1); \
+         __cow_e = __cow_next(&__cow_e->list, (snap)))
+
+/// @brief 获取当前版本的快照，O(1)
+/// @param cl 指向多版本链表的指针
+/// @param snap 指向快照的指针
+/// @return 成功，返回 0。快照数已满，返回 -1。
+static inline int cow_list_snapshot(struct cow_list *cl, struct cow_snapshot *snap)
+{
+    for (int i = 0; i < COW_MAX_READERS; i++)
+    {
+        unsigned long expect = 0;
+        unsigned long v = atomic_load(&cl->version);
+        if (atomic_compare_exchange_strong(&cl->readers[i], &expect, v))
+        {
+            // 登记后版本又变了就重新登记，保证写者回收时一定能看到这个快照
+            unsigned long cur;
+            while ((cur = atomic_load(&cl->version)) != v)
+            {
+                v = cur;
+                atomic_store(&cl->readers[i], v);
+            }
+            snap->cl = cl;
+            snap->version = v;
+            snap->slot = i;
+            return 0;
+        }
+    }
+
+    printf("Too many snapshots!\n");
+    return -1;
+}
+
+/// @brief 释放快照
+/// @param snap 指向快照的指针
+static inline void cow_snapshot_release(struct cow_snapshot *snap)
+{
+    atomic_store(&snap->cl->readers[snap->slot], 0);
+}
+
+/// @brief 活跃快照中最老的版本，没有快照时返回当前版本
+static inline unsigned long __cow_oldest(struct cow_list *cl)
+{
+    unsigned long oldest = atomic_load(&cl->version);
+
+    for (int i = 0; i < COW_MAX_READERS; i++)
+    {
+        unsigned long v = atomic_load(&cl->readers[i]);
+        if (v != 0 && v < oldest)
+        {
+            oldest = v;
+        }
+    }
+
+    return oldest;
+}
+
+/// @brief 摘下所有快照都看不到的已删除节点，放进 retired。调用前必须持有写者锁
+/// @param cl 指向多版本链表的指针
+/// @param oldest 活跃快照中最老的版本
+static inline void __cow_unlink_dead(struct cow_list *cl, unsigned long oldest)
+{
+    unsigned long retire = atomic_load(&cl->version) + 1;
+    unsigned long min_death = COW_ALIVE;
+    struct list_head *pos, *n;
+    int unlinked = 0;
+
+    list_for_each_safe(pos, n, &cl->head)
+    {
+        struct cow_entry *e = list_entry(pos, struct cow_entry, list);
+        if (e->death == COW_ALIVE)
+        {
+            continue;
+        }
+        if (e->death <= oldest)
+        {
+            __cow_unlink(pos);
+            e->retire = retire;
+            e->retire_next = cl->retired;
+            cl->retired = e;
+            cl->nr_dead--;
+            unlinked++;
+        }
+        else if (e->death < min_death)
+        {
+            min_death = e->death;
+        }
+    }
+    cl->min_death = min_death;
+    if (unlinked > 0)
+    {
+        // 之后登记的读者都看不到被摘下的节点
+        atomic_store(&cl->version, retire);
+        if (retire < cl->min_retire)
+        {
+            cl->min_retire = retire;
+        }
+    }
+}
+
+/// @brief 释放在所有读者开始之前就已摘下的节点。调用前必须持有写者锁
+/// @param cl 指向多版本链表的指针
+/// @param oldest 活跃快照中最老的版本
+/// @return 释放的节点数
+static inline int __cow_free_retired(struct cow_list *cl, unsigned long oldest)
+{
+    unsigned long min_retire = COW_ALIVE;
+    struct cow_entry **pp = &cl->retired;
+    int count = 0;
+
+    while (*pp != NULL)
+    {
+        struct cow_entry *e = *pp;
+        if (e->retire <= oldest)
+        {
+            *pp = e->retire_next;
+            cl->release(e);
+            count++;
+        }
+        else
+        {
+            if (e->retire < min_retire)
+            {
+                min_retire = e->retire;
+            }
+            pp = &e->retire_next;
+        }
+    }
+    cl->min_retire = min_retire;
+
+    return count;
+}
+
+/// @brief 回收节点。调用前必须持有写者锁
+/// @param cl 指向多版本链表的指针
+/// @return 本次释放的节点数
+/// @note 第一步摘下所有快照都看不到的已删除节点，第二步释放在所有读者开始之前就已摘下的节点。
+static inline int __cow_reclaim(struct cow_list *cl)
+{
+    __cow_unlink_dead(cl, __cow_oldest(cl));
+    return __cow_free_retired(cl, __cow_oldest(cl));
+}
+
+/// @brief 已删除的节点太多时回收。调用前必须持有写者锁
+/// @note 只有最老的快照已经越过最早的 death 时才遍历链表，否则长时间持有的快照会让每次写入都白白遍历一遍。
+static inline void __cow_maybe_reclaim(struct cow_list *cl)
+{
+    int too_many = cl->nr_dead > 64 && cl->nr_dead * 4 > cl->nr_live;
+    unsigned long oldest;
+
+    if (!too_many && cl->retired == NULL)
+    {
+        return;
+    }
+
+    oldest = __cow_oldest(cl);
+    if (too_many && cl->min_death <= oldest)
+    {
+        __cow_unlink_dead(cl, oldest);
+        oldest = __cow_oldest(cl);
+    }
+    if (cl->retired != NULL && cl->min_retire <= oldest)
+    {
+        __cow_free_retired(cl, oldest);
+    }
+}
+
+/// @brief 节点是否还可以作为插入位置：没有被删除，也没有被摘下
+static inline int __cow_linkable(struct cow_entry *e)
+{
+    return e->death == COW_ALIVE && e->retire == 0;
+}
+
+/// @brief 在 pos 之后插入节点，新节点从下一个版本开始可见
+/// @param cl 指向多版本链表的指针
+/// @param entry 新节点
+/// @param pos 插入位置，为 NULL 时插在表头
+/// @return 成功，返回 0。pos 已被删除，返回 -1。
+static inline int cow_list_add(struct cow_list *cl, struct cow_entry *entry, struct cow_entry *pos)
+{
+    struct list_head *prev = pos != NULL ? &pos->list : &cl->head;
+
+    pthread_mutex_lock(&cl->lock);
+    // 已删除的节点随时可能被回收摘下，插在它后面的节点会从链表中丢失
+    if (pos != NULL && !__cow_linkable(pos))
+    {
+        pthread_mutex_unlock(&cl->lock);
+        return -1;
+    }
+    unsigned long v = atomic_load(&cl->version) + 1;
+    entry->birth = v;
+    entry->death = COW_ALIVE;
+    entry->retire = 0;
+    __cow_link(&entry->list, prev, prev->next);
+    cl->nr_live++;
+    atomic_store(&cl->version, v);
+    __cow_maybe_reclaim(cl);
+    pthread_mutex_unlock(&cl->lock);
+
+    return 0;
+}
+
+/// @brief 在表尾插入节点，新节点从下一个版本开始可见
+/// @param cl 指向多版本链表的指针
+/// @param entry 新节点
+static inline void cow_list_add_tail(struct cow_list *cl, struct cow_entry *entry)
+{
+    pthread_mutex_lock(&cl->lock);
+    unsigned long v = atomic_load(&cl->version) + 1;
+    entry->birth = v;
+    entry->death = COW_ALIVE;
+    entry->retire = 0;
+    __cow_link(&entry->list, cl->head.prev, &cl->head);
+    cl->nr_live++;
+    atomic_store(&cl->version, v);
+    __cow_maybe_reclaim(cl);
+    pthread_mutex_unlock(&cl->lock);
+}
+
+/// @brief 删除节点，已有的快照仍能看到它
+/// @param cl 指向多版本链表的指针
+/// @param entry 要删除的节点
+/// @return 成功，返回 0。节点已被删除，返回 -1。
+static inline int cow_list_del(struct cow_list *cl, struct cow_entry *entry)
+{
+    pthread_mutex_lock(&cl->lock);
+    if (entry->death != COW_ALIVE)
+    {
+        pthread_mutex_unlock(&cl->lock);
+        return -1;
+    }
+    unsigned long v = atomic_load(&cl->version) + 1;
+    __atomic_store_n(&entry->death, v, __ATOMIC_RELEASE);
+    cl->nr_live--;
+    cl->nr_dead++;
+    if (v < cl->min_death)
+    {
+        cl->min_death = v;
+    }
+    atomic_store(&cl->version, v);
+    __cow_maybe_reclaim(cl);
+    pthread_mutex_unlock(&cl->lock);
+
+    return 0;
+}
+
+/// @brief 用副本替换节点并放到 pos 之后，用于移动或修改节点
+/// @param cl 指向多版本链表的指针
+/// @param entry 要替换的节点
+/// @param copy 调用者准备好的副本
+/// @param pos 副本的位置，为 NULL 时放在 entry 原来的位置
+/// @return 成功，返回 0。节点或 pos 已被删除，返回 -1。
+/// @note 已有的快照看到的仍是旧节点和旧位置，之后的快照只看到副本。
+static inline int cow_list_replace(struct cow_list *cl, struct cow_entry *entry,
+                                   struct cow_entry *copy, struct cow_entry *pos)
+{
+    pthread_mutex_lock(&cl->lock);
+    if (entry->death != COW_ALIVE || (pos != NULL && pos != entry && !__cow_linkable(pos)))
+    {
+        pthread_mutex_unlock(&cl->lock);
+        return -1;
+    }
+    struct list_head *prev = pos != NULL ? &pos->list : &entry->list;
+    unsigned long v = atomic_load(&cl->version) + 1;
+    copy->birth = v;
+    copy->death = COW_ALIVE;
+    copy->retire = 0;
+    __cow_link(&copy->list, prev, prev->next);
+    __atomic_store_n(&entry->death, v, __ATOMIC_RELEASE);
+    cl->nr_dead++;
+    if (v < cl->min_death)
+    {
+        cl->min_death = v;
+    }
+    atomic_store(&cl->version, v);
+    __cow_maybe_reclaim(cl);
+    pthread_mutex_unlock(&cl->lock);
+
+    return 0;
+}
+
+/// @brief 立即回收所有可以回收的节点
+/// @param cl 指向多版本链表的指针
+/// @return 释放的节点数
+static inline int cow_list_reclaim(struct cow_list *cl)
+{
+    pthread_mutex_lock(&cl->lock);
+    int count = __cow_reclaim(cl);
+    pthread_mutex_unlock(&cl->lock);
+
+    return count;
+}
+
+/// @brief 释放所有节点，调用时不能有活跃的快照
+/// @param cl 指向多版本链表的指针
+static inline void cow_list_destroy(struct cow_list *cl)
+{
+    struct list_head *pos, *n;
+
+    pthread_mutex_lock(&cl->lock);
+    __cow_reclaim(cl);
+    list_for_each_safe(pos, n, &cl->head)
+    {
+        cl->release(list_entry(pos, struct cow_entry, list));
+    }
+    INIT_LIST_HEAD(&cl->head);
+    cl->nr_live = 0;
+    cl->nr_dead = 0;
+    pthread_mutex_unlock(&cl->lock);
+    pthread_mutex_destroy(&cl->lock);
+}
+
+#endif
@@ -0,0 +1,304 @@
+// list_cow.h 写者吞吐量测试
+// 编译：gcc -O2 -o list_cow_bench list_cow_bench.c -lpthread
+// 用法：./list_cow_bench [-j] [-n 节点数] [-w 写操作数] [-d 已删除节点百分比] [-t 读者线程数]
+//   -j  输出 JSON，默认输出 CSV
+// 先建好 n 个节点的链表，在一个快照下删除其中 d% 的节点，让它们留在链表中等待回收，
+// 再分别执行 w 次 cow_list_add_tail、cow_list_del、cow_list_replace，输出每秒写操作数。
+// 对比三种情况：没有快照（none）、一个快照在整个测试期间一直持有（long_snapshot）、
+// 若干读者线程不停地取快照并遍历（readers）。长时间持有的快照不应让每次写入都遍历整条链表。
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <getopt.h>
+
+#include "list_cow.h"
+
+enum
+{
+    MODE_NONE,
+    MODE_LONG_SNAPSHOT,
+    MODE_READERS,
+    NR_MODES,
+};
+
+enum
+{
+    OP_ADD_TAIL,
+    OP_DEL,
+    OP_REPLACE,
+    NR_OPS,
+};
+
+static const char *mode_name[NR_MODES] = {"none", "long_snapshot", "readers"};
+static const char *op_name[NR_OPS] = {"add_tail", "del", "replace"};
+
+struct item
+{
+    int data;
+    struct cow_entry entry;
+};
+
+static struct cow_list cl;
+static atomic_int stop;
+static long nr_freed;
+
+/// @brief 获取单调时钟，单位纳秒
+static long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/// @brief 释放节点的回调，在写者锁下调用
+static void release_item(struct cow_entry *entry)
+{
+    free(container_of(entry, struct item, entry));
+    nr_freed++;
+}
+
+static struct item *new_item(int data)
+{
+    struct item *it = (struct item *)malloc(sizeof(struct item));
+    if (it == NULL)
+    {
+        perror("malloc");
+        exit(-1);
+    }
+    it->data = data;
+
+    return it;
+}
+
+/// @brief 读者线程：不停地取快照并遍历
+static void *reader_main(void *arg)
+{
+    long *sum = arg;
+
+    while (!atomic_load(&stop))
+    {
+        struct cow_snapshot snap;
+        struct item *pos;
+
+        if (cow_list_snapshot(&cl, &snap) != 0)
+        {
+            continue;
+        }
+        cow_for_each_entry(pos, &snap, entry)
+        {
+            *sum += pos->data;
+        }
+        cow_snapshot_release(&snap);
+    }
+
+    return NULL;
+}
+
+/// @brief 打乱数组
+static void shuffle(struct item **items, long n, unsigned int *seed)
+{
+    for (long i = n - 1; i > 0; i--)
+    {
+        long j = rand_r(seed) % (i + 1);
+        struct item *t = items[i];
+        items[i] = items[j];
+        items[j] = t;
+    }
+}
+
+/// @brief 执行一轮测试
+/// @param mode 快照情况
+/// @param op 写操作
+/// @param nr_nodes 节点数
+/// @param nr_writes 写操作数
+/// @param dead_pct 已删除节点百分比
+/// @param nr_readers 读者线程数
+/// @param freed 写操作期间释放的节点数
+/// @return 成功，返回耗时（纳秒）。失败，返回 -1。
+static double run_bench(int mode, int op, long nr_nodes, long nr_writes, int dead_pct, int nr_readers,
+                        long *freed)
+{
+    struct item **live = (struct item **)malloc(sizeof(struct item *) * nr_nodes);
+    pthread_t readers[nr_readers];
+    long sums[nr_readers];
+    struct cow_snapshot snap;
+    unsigned int seed = 12345;
+    long nr_live = nr_nodes;
+    long long start, end;
+
+    if (live == NULL)
+    {
+        perror("malloc");
+        return -1;
+    }
+    cow_list_init(&cl, release_item);
+    for (long i = 0; i < nr_nodes; i++)
+    {
+        live[i] = new_item((int)i);
+        cow_list_add_tail(&cl, &live[i]->entry);
+    }
+
+    // 在快照下删除，已删除的节点留在链表中
+    if (cow_list_snapshot(&cl, &snap) != 0)
+    {
+        return -1;
+    }
+    shuffle(live, nr_nodes, &seed);
+    while (nr_live > nr_nodes - nr_nodes * dead_pct / 100)
+    {
+        cow_list_del(&cl, &live[--nr_live]->entry);
+    }
+    if (mode != MODE_LONG_SNAPSHOT)
+    {
+        cow_snapshot_release(&snap);
+    }
+
+    atomic_store(&stop, 0);
+    for (int i = 0; mode == MODE_READERS && i < nr_readers; i++)
+    {
+        sums[i] = 0;
+        if (pthread_create(&readers[i], NULL, reader_main, &sums[i]) != 0)
+        {
+            perror("pthread_create");
+            return -1;
+        }
+    }
+
+    nr_freed = 0;
+    start = now_ns();
+    for (long i = 0; i < nr_writes; i++)
+    {
+        long k = i % nr_live;
+        struct item *it;
+
+        switch (op)
+        {
+        case OP_ADD_TAIL:
+            cow_list_add_tail(&cl, &new_item((int)i)->entry);
+            break;
+        case OP_DEL:
+            // 删完一遍后补回节点，保证每次都删除存活的节点
+            if (cow_list_del(&cl, &live[k]->entry) == 0)
+            {
+                live[k] = new_item((int)i);
+                cow_list_add_tail(&cl, &live[k]->entry);
+            }
+            break;
+        case OP_REPLACE:
+            it = new_item(live[k]->data + 1);
+            if (cow_list_replace(&cl, &live[k]->entry, &it->entry, NULL) == 0)
+            {
+                live[k] = it;
+            }
+            else
+            {
+                free(it);
+            }
+            break;
+        }
+    }
+    end = now_ns();
+    *freed = nr_freed;
+
+    atomic_store(&stop, 1);
+    for (int i = 0; mode == MODE_READERS && i < nr_readers; i++)
+    {
+        pthread_join(readers[i], NULL);
+    }
+    if (mode == MODE_LONG_SNAPSHOT)
+    {
+        cow_snapshot_release(&snap);
+    }
+    cow_list_destroy(&cl);
+    free(live);
+
+    return end - start;
+}
+
+int main(int argc, char *argv[])
+{
+    long nr_nodes = 100000;
+    long nr_writes = 20000;
+    int dead_pct = 30;
+    int nr_readers = 2;
+    int json_output = 0;
+    int first_record = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "jn:w:d:t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            json_output = 1;
+            break;
+        case 'n':
+            nr_nodes = atol(optarg);
+            break;
+        case 'w':
+            nr_writes = atol(optarg);
+            break;
+        case 'd':
+            dead_pct = atoi(optarg);
+            break;
+        case 't':
+            nr_readers = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j] [-n nodes] [-w writes] [-d dead_percent] [-t readers]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (nr_nodes <= 0 || nr_writes <= 0 || dead_pct < 0 || dead_pct >= 100 || nr_readers <= 0 ||
+        nr_readers >= COW_MAX_READERS)
+    {
+        fprintf(stderr, "invalid argument\n");
+        return -1;
+    }
+
+    if (json_output)
+    {
+        printf("[\n");
+    }
+    else
+    {
+        printf("snapshots,op,nodes,dead_pct,writes,ms,writes_per_sec,freed\n");
+    }
+
+    for (int mode = 0; mode < NR_MODES; mode++)
+    {
+        for (int op = 0; op < NR_OPS; op++)
+        {
+            long freed;
+            double ns = run_bench(mode, op, nr_nodes, nr_writes, dead_pct, nr_readers, &freed);
+            if (ns < 0)
+            {
+                return -1;
+            }
+
+            double rate = nr_writes / (ns / 1e9);
+            if (json_output)
+            {
+                printf("%s  {\"snapshots\": \"%s\", \"op\": \"%s\", \"nodes\": %ld, \"dead_pct\": %d, "
+                       "\"writes\": %ld, \"ms\": %.3f, \"writes_per_sec\": %.0f, \"freed\": %ld}",
+                       first_record ? "" : ",\n", mode_name[mode], op_name[op], nr_nodes, dead_pct,
+                       nr_writes, ns / 1e6, rate, freed);
+            }
+            else
+            {
+                printf("%s,%s,%ld,%d,%ld,%.3f,%.0f,%ld\n", mode_name[mode], op_name[op], nr_nodes, dead_pct,
+                       nr_writes, ns / 1e6, rate, freed);
+            }
+            first_record = 0;
+            fflush(stdout);
+        }
+    }
+
+    if (json_output)
+    {
+        printf("\n]\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,290 @@
+#ifndef _LIST_FC_H
+#define _LIST_FC_H
+
+// 内核链表的 flat combining（平铺合并）前端
+// 多个线程修改同一条链表时，每个线程把操作写进自己独占缓存行的发布记录里，
+// 抢到锁的线程（合并者）一次性替所有线程执行挂起的操作，再统一释放锁。
+// 这样锁和表头只在合并者的缓存里来回，其他线程只在自己的记录上自旋。
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list.h"
+
+#define FC_CACHELINE 64
+#define FC_SPIN_LIMIT 128 // 自旋这么多次后让出 CPU
+
+// 可以发布的操作，对应 list.h 中的同名函数
+enum fc_op
+{
+    FC_NONE = 0, // 记录空闲，或操作已经被执行
+    FC_ADD,
+    FC_ADD_TAIL,
+    FC_DEL,
+    FC_DEL_INIT,
+    FC_MOVE,
+    FC_MOVE_TAIL,
+};
+
+// 发布记录，每个线程一个，独占一条缓存行
+struct fc_record
+{
+    atomic_int op;
+    atomic_int owned; // 是否已被某个线程占用
+    struct list_head *entry;
+    struct list_head *head;
+} __attribute__((aligned(FC_CACHELINE)));
+
+// 由 flat combining 保护的链表
+struct fc_list
+{
+    struct list_head head;
+    atomic_int nr_used; // 曾经占用过的最大记录下标加一，合并者只扫描这一段
+    int nr_slots;
+    struct fc_record *slots;
+    atomic_int lock __attribute__((aligned(FC_CACHELINE)));
+};
+
+/// @brief 初始化
+/// @param fc 指向 fc_list 的指针
+/// @param nr_slots 发布记录个数，即最多能有多少个线程同时使用
+/// @return 成功，返回 0。失败，返回 -1。
+static inline int fc_list_init(struct fc_list *fc, int nr_slots)
+{
+    INIT_LIST_HEAD(&fc->head);
+    atomic_init(&fc->nr_used, 0);
+    atomic_init(&fc->lock, 0);
+    fc->nr_slots = nr_slots;
+    fc->slots = (struct fc_record *)aligned_alloc(FC_CACHELINE, sizeof(struct fc_record) * nr_slots);
+    if (fc->slots == NULL)
+    {
+        perror("aligned_alloc");
+        return -1;
+    }
+    for (int i = 0; i < nr_slots; i++)
+    {
+        atomic_init(&fc->slots[i].op, FC_NONE);
+        atomic_init(&fc->slots[i].owned, 0);
+        fc->slots[i].entry = NULL;
+        fc->slots[i].head = NULL;
+    }
+
+    return 0;
+}
+
+/// @brief 释放发布记录，不会释放链表中的节点
+/// @param fc 指向 fc_list 的指针
+static inline void fc_list_exit(struct fc_list *fc)
+{
+    free(fc->slots);
+    fc->slots = NULL;
+}
+
+/// @brief 为当前线程申请一个发布记录，优先复用已释放的记录
+/// @param fc 指向 fc_list 的指针
+/// @return 成功，返回指向发布记录的指针。记录都被占用，返回 NULL。
+static inline struct fc_record *fc_register(struct fc_list *fc)
+{
+    for (int i = 0; i < fc->nr_slots; i++)
+    {
+        int expect = 0;
+        if (atomic_compare_exchange_strong(&fc->slots[i].owned, &expect, 1))
+        {
+            int nr_used = atomic_load(&fc->nr_used);
+            while (nr_used <= i && !atomic_compare_exchange_weak(&fc->nr_used, &nr_used, i + 1))
+            {
+            }
+            return &fc->slots[i];
+        }
+    }
+
+    printf("fc_list slots exhausted!\n");
+    return NULL;
+}
+
+/// @brief 释放发布记录，线程不再使用这条链表时调用
+/// @param fc 指向 fc_list 的指针
+/// @param rec 由 fc_register 申请的发布记录
+/// @note fc_list_apply 返回时操作已经执行完，记录可以直接交给其他线程复用。
+static inline void fc_unregister(struct fc_list *fc, struct fc_record *rec)
+{
+    if (rec != NULL)
+    {
+        atomic_store(&rec->owned, 0);
+    }
+}
+
+/// @brief 尝试获取锁
+/// @param fc 指向 fc_list 的指针
+/// @return 成功，返回 1。失败，返回 0。
+static inline int __fc_trylock(struct fc_list *fc)
+{
+    return atomic_load_explicit(&fc->lock, memory_order_relaxed) == 0 &&
+           atomic_exchange_explicit(&fc->lock, 1, memory_order_acquire) == 0;
+}
+
+/// @brief 释放锁
+/// @param fc 指向 fc_list 的指针
+static inline void __fc_unlock(struct fc_list *fc)
+{
+    atomic_store_explicit(&fc->lock, 0, memory_order_release);
+}
+
+/// @brief 执行一条发布记录中的操作
+/// @param fc 指向 fc_list 的指针
+/// @param rec 指向发布记录的指针
+/// @param op 操作
+static inline void __fc_do_op(struct fc_list *fc, struct fc_record *rec, int op)
+{
+    struct list_head *head = rec->head != NULL ? rec->head : &fc->head;
+
+    switch (op)
+    {
+    case FC_ADD:
+        list_add(rec->entry, head);
+        break;
+    case FC_ADD_TAIL:
+        list_add_tail(rec->entry, head);
+        break;
+    case FC_DEL:
+        list_del(rec->entry);
+        break;
+    case FC_DEL_INIT:
+        list_del_init(rec->entry);
+        break;
+    case FC_MOVE:
+        list_move(rec->entry, head);
+        break;
+    case FC_MOVE_TAIL:
+        list_move_tail(rec->entry, head);
+        break;
+    default:
+        break;
+    }
+}
+
+/// @brief 合并者扫描所有发布记录，批量执行挂起的操作。调用前必须持有锁
+/// @param fc 指向 fc_list 的指针
+/// @return 本次执行的操作个数
+static inline int __fc_combine(struct fc_list *fc)
+{
+    int nr_used = atomic_load_explicit(&fc->nr_used, memory_order_acquire);
+    int count = 0;
+
+    if (nr_used > fc->nr_slots)
+    {
+        nr_used = fc->nr_slots;
+    }
+    for (int i = 0; i < nr_used; i++)
+    {
+        struct fc_record *rec = &fc->slots[i];
+        int op = atomic_load_explicit(&rec->op, memory_order_acquire);
+        if (op != FC_NONE)
+        {
+            __fc_do_op(fc, rec, op);
+            atomic_store_explicit(&rec->op, FC_NONE, memory_order_release);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/// @brief 发布一个操作并等待它被执行，可能由自己或其他线程执行
+/// @param fc 指向 fc_list 的指针
+/// @param rec 当前线程的发布记录
+/// @param op 操作
+/// @param entry 要操作的节点
+/// @param head 操作的位置，为 NULL 时使用 fc->head。FC_DEL 和 FC_DEL_INIT 忽略此参数
+static inline void fc_list_apply(struct fc_list *fc, struct fc_record *rec, int op,
+                                 struct list_head *entry, struct list_head *head)
+{
+    int spins = 0;
+
+    rec->entry = entry;
+    rec->head = head;
+    atomic_store_explicit(&rec->op, op, memory_order_release);
+
+    while (atomic_load_explicit(&rec->op, memory_order_acquire) != FC_NONE)
+    {
+        if (__fc_trylock(fc))
+        {
+            __fc_combine(fc);
+            __fc_unlock(fc);
+            break;
+        }
+        if (++spins == FC_SPIN_LIMIT)
+        {
+            spins = 0;
+            sched_yield();
+        }
+    }
+}
+
+/// @brief fc_list_add - 在 head 之后插入节点，head 为 NULL 时插在表头
+static inline void fc_list_add(struct fc_list *fc, struct fc_record *rec,
+                               struct list_head *entry, struct list_head *head)
+{
+    fc_list_apply(fc, rec, FC_ADD, entry, head);
+}
+
+/// @brief fc_list_add_tail - 在 head 之前插入节点，head 为 NULL 时插在表尾
+static inline void fc_list_add_tail(struct fc_list *fc, struct fc_record *rec,
+                                    struct list_head *entry, struct list_head *head)
+{
+    fc_list_apply(fc, rec, FC_ADD_TAIL, entry, head);
+}
+
+/// @brief fc_list_del - 从链表中删除节点
+static inline void fc_list_del(struct fc_list *fc, struct fc_record *rec, struct list_head *entry)
+{
+    fc_list_apply(fc, rec, FC_DEL, entry, NULL);
+}
+
+/// @brief fc_list_del_init - 从链表中删除节点并重新初始化
+static inline void fc_list_del_init(struct fc_list *fc, struct fc_record *rec, struct list_head *entry)
+{
+    fc_list_apply(fc, rec, FC_DEL_INIT, entry, NULL);
+}
+
+/// @brief fc_list_move - 把节点移动到 head 之后，head 为 NULL 时移到表头
+static inline void fc_list_move(struct fc_list *fc, struct fc_record *rec,
+                                struct list_head *entry, struct list_head *head)
+{
+    fc_list_apply(fc, rec, FC_MOVE, entry, head);
+}
+
+/// @brief fc_list_move_tail - 把节点移动到 head 之前，head 为 NULL 时移到表尾
+static inline void fc_list_move_tail(struct fc_list *fc, struct fc_record *rec,
+                                     struct list_head *entry, struct list_head *head)
+{
+    fc_list_apply(fc, rec, FC_MOVE_TAIL, entry, head);
+}
+
+/// @brief 获取锁以便遍历链表，获取后先替其他线程执行挂起的操作
+/// @param fc 指向 fc_list 的指针
+static inline void fc_list_lock(struct fc_list *fc)
+{
+    int spins = 0;
+
+    while (!__fc_trylock(fc))
+    {
+        if (++spins == FC_SPIN_LIMIT)
+        {
+            spins = 0;
+            sched_yield();
+        }
+    }
+    __fc_combine(fc);
+}
+
+/// @brief 遍历结束后释放锁
+/// @param fc 指向 fc_list 的指针
+static inline void fc_list_unlock(struct fc_list *fc)
+{
+    __fc_unlock(fc);
+}
+
+#endif
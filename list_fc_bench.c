@@ -0,0 +1,318 @@
+// list_fc.h 与互斥锁、自旋锁的吞吐量和尾延迟对比测试
+// 编译：gcc -O2 -o list_fc_bench list_fc_bench.c -lpthread
+// 用法：./list_fc_bench [-j] [-t 最大线程数] [-n 每线程操作数] [-k 每线程节点数]
+//   -j  输出 JSON，默认输出 CSV
+// 所有线程修改同一条链表，每个线程轮流对自己的节点执行 list_del、list_add_tail、list_move_tail。
+// 分别用 flat combining、pthread 互斥锁和自旋锁保护链表，线程数从 1 按 2 倍递增到最大线程数（默认 64），
+// 输出每秒操作数，以及单次操作延迟的 p50、p99、p999 和最大值。
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <getopt.h>
+
+#include "list_fc.h"
+
+enum
+{
+    LOCK_FC,
+    LOCK_MUTEX,
+    LOCK_SPIN,
+    NR_LOCKS,
+};
+
+static const char *lock_name[NR_LOCKS] = {"flat_combining", "mutex", "spinlock"};
+
+typedef struct node
+{
+    int data;
+    struct list_head list;
+} listnode;
+
+// 被测链表，三种保护方式共用同一个表头
+struct bench_list
+{
+    int kind;
+    struct fc_list fc;
+    pthread_mutex_t mutex;
+    atomic_int spin __attribute__((aligned(FC_CACHELINE)));
+};
+
+// 每个线程的参数和结果
+struct bench_thread
+{
+    pthread_t tid;
+    struct bench_list *bl;
+    listnode *nodes;
+    int nr_nodes;
+    long nr_ops;
+    unsigned int *latency; // 每次操作的延迟，单位纳秒
+    long long start;       // 开始和结束时间，单位纳秒
+    long long end;
+};
+
+static pthread_barrier_t barrier;
+
+/// @brief 获取单调时钟，单位纳秒
+static long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void spin_lock(atomic_int *lock)
+{
+    int spins = 0;
+
+    while (atomic_exchange_explicit(lock, 1, memory_order_acquire))
+    {
+        while (atomic_load_explicit(lock, memory_order_relaxed))
+        {
+            if (++spins == FC_SPIN_LIMIT)
+            {
+                spins = 0;
+                sched_yield();
+            }
+        }
+    }
+}
+
+static void spin_unlock(atomic_int *lock)
+{
+    atomic_store_explicit(lock, 0, memory_order_release);
+}
+
+/// @brief 在锁保护下执行一个操作
+static void locked_op(struct bench_list *bl, int op, struct list_head *entry)
+{
+    if (bl->kind == LOCK_MUTEX)
+    {
+        pthread_mutex_lock(&bl->mutex);
+    }
+    else
+    {
+        spin_lock(&bl->spin);
+    }
+
+    switch (op)
+    {
+    case FC_DEL:
+        list_del(entry);
+        break;
+    case FC_ADD_TAIL:
+        list_add_tail(entry, &bl->fc.head);
+        break;
+    case FC_MOVE_TAIL:
+        list_move_tail(entry, &bl->fc.head);
+        break;
+    }
+
+    if (bl->kind == LOCK_MUTEX)
+    {
+        pthread_mutex_unlock(&bl->mutex);
+    }
+    else
+    {
+        spin_unlock(&bl->spin);
+    }
+}
+
+/// @brief 测试线程：轮流删除、插回、移动自己的节点
+static void *bench_main(void *arg)
+{
+    static const int ops[] = {FC_DEL, FC_ADD_TAIL, FC_MOVE_TAIL};
+    struct bench_thread *t = arg;
+    struct bench_list *bl = t->bl;
+    struct fc_record *rec = NULL;
+
+    if (bl->kind == LOCK_FC)
+    {
+        rec = fc_register(&bl->fc);
+        if (rec == NULL)
+        {
+            exit(-1);
+        }
+    }
+
+    pthread_barrier_wait(&barrier);
+    t->start = now_ns();
+    for (long i = 0; i < t->nr_ops; i++)
+    {
+        // 每个节点依次经历 del、add_tail、move_tail，保证 del 时节点一定在链表中
+        int op = ops[(i / t->nr_nodes) % 3];
+        struct list_head *entry = &t->nodes[i % t->nr_nodes].list;
+        long long start = now_ns();
+
+        if (bl->kind == LOCK_FC)
+        {
+            fc_list_apply(&bl->fc, rec, op, entry, NULL);
+        }
+        else
+        {
+            locked_op(bl, op, entry);
+        }
+        t->latency[i] = (unsigned int)(now_ns() - start);
+    }
+    t->end = now_ns();
+
+    fc_unregister(&bl->fc, rec);
+    return NULL;
+}
+
+static int cmp_uint(const void *a, const void *b)
+{
+    unsigned int x = *(const unsigned int *)a;
+    unsigned int y = *(const unsigned int *)b;
+
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[])
+{
+    int max_threads = 64;
+    long nr_ops = 100000;
+    int nr_nodes = 64;
+    int json_output = 0;
+    int first_record = 1;
+    struct bench_list bl;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "jt:n:k:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            json_output = 1;
+            break;
+        case 't':
+            max_threads = atoi(optarg);
+            break;
+        case 'n':
+            nr_ops = atol(optarg);
+            break;
+        case 'k':
+            nr_nodes = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j] [-t max_threads] [-n ops_per_thread] [-k nodes_per_thread]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (max_threads <= 0 || nr_ops <= 0 || nr_nodes <= 0)
+    {
+        fprintf(stderr, "invalid argument\n");
+        return -1;
+    }
+
+    struct bench_thread *threads = (struct bench_thread *)calloc(max_threads, sizeof(struct bench_thread));
+    listnode *nodes = (listnode *)calloc((size_t)max_threads * nr_nodes, sizeof(listnode));
+    unsigned int *latency = (unsigned int *)malloc(sizeof(unsigned int) * max_threads * nr_ops);
+    if (threads == NULL || nodes == NULL || latency == NULL)
+    {
+        perror("calloc");
+        return -1;
+    }
+    // 发布记录只按最大线程数申请，各轮测试结束时释放，下一轮复用
+    if (fc_list_init(&bl.fc, max_threads) != 0)
+    {
+        return -1;
+    }
+    pthread_mutex_init(&bl.mutex, NULL);
+    atomic_init(&bl.spin, 0);
+
+    if (json_output)
+    {
+        printf("[\n");
+    }
+    else
+    {
+        printf("lock,threads,ops,mops_per_sec,p50_ns,p99_ns,p999_ns,max_ns\n");
+    }
+
+    for (int nr = 1;; nr *= 2)
+    {
+        if (nr > max_threads)
+        {
+            nr = max_threads;
+        }
+        for (int kind = 0; kind < NR_LOCKS; kind++)
+        {
+            long total = (long)nr * nr_ops;
+            long long start, end;
+
+            bl.kind = kind;
+            INIT_LIST_HEAD(&bl.fc.head);
+            for (int i = 0; i < nr * nr_nodes; i++)
+            {
+                list_add_tail(&nodes[i].list, &bl.fc.head);
+            }
+            pthread_barrier_init(&barrier, NULL, nr + 1);
+            for (int i = 0; i < nr; i++)
+            {
+                threads[i].bl = &bl;
+                threads[i].nodes = &nodes[i * nr_nodes];
+                threads[i].nr_nodes = nr_nodes;
+                threads[i].nr_ops = nr_ops;
+                threads[i].latency = &latency[i * nr_ops];
+                if (pthread_create(&threads[i].tid, NULL, bench_main, &threads[i]) != 0)
+                {
+                    perror("pthread_create");
+                    return -1;
+                }
+            }
+
+            pthread_barrier_wait(&barrier);
+            for (int i = 0; i < nr; i++)
+            {
+                pthread_join(threads[i].tid, NULL);
+            }
+            // 从最早开始的线程算到最晚结束的线程
+            start = threads[0].start;
+            end = threads[0].end;
+            for (int i = 1; i < nr; i++)
+            {
+                start = threads[i].start < start ? threads[i].start : start;
+                end = threads[i].end > end ? threads[i].end : end;
+            }
+            pthread_barrier_destroy(&barrier);
+
+            qsort(latency, total, sizeof(unsigned int), cmp_uint);
+            double mops = total / ((end - start) / 1e3);
+            unsigned int p50 = latency[total * 50 / 100];
+            unsigned int p99 = latency[total * 99 / 100];
+            unsigned int p999 = latency[total * 999 / 1000];
+            unsigned int max = latency[total - 1];
+
+            if (json_output)
+            {
+                printf("%s  {\"lock\": \"%s\", \"threads\": %d, \"ops\": %ld, \"mops_per_sec\": %.3f, "
+                       "\"p50_ns\": %u, \"p99_ns\": %u, \"p999_ns\": %u, \"max_ns\": %u}",
+                       first_record ? "" : ",\n", lock_name[kind], nr, total, mops, p50, p99, p999, max);
+            }
+            else
+            {
+                printf("%s,%d,%ld,%.3f,%u,%u,%u,%u\n", lock_name[kind], nr, total, mops, p50, p99, p999, max);
+            }
+            first_record = 0;
+            fflush(stdout);
+        }
+
+        if (nr == max_threads)
+        {
+            break;
+        }
+    }
+
+    if (json_output)
+    {
+        printf("\n]\n");
+    }
+    fc_list_exit(&bl.fc);
+    pthread_mutex_destroy(&bl.mutex);
+    free(threads);
+    free(nodes);
+    free(latency);
+
+    return 0;
+}
@@ -0,0 +1,993 @@
+// list.h 遍历宏和修改函数的硬件性能计数器测试
+// 编译：gcc -O2 -o list_perf list_perf.c
+// 用法：./list_perf [-j] [-b] [-m 最大节点数] [-v 每项最少访问的节点数]
+//   -j  输出 JSON，默认输出 CSV
+//   -b  改为测试 list_blob.h 的变长数据节点，与节点只保存数据指针的设计对比
+// 通过 perf_event_open 统计每个节点的周期数、缓存未命中、TLB 未命中和分支预测失败次数，
+// 计数器不可用时（例如 perf_event_paranoid 限制）只输出耗时，其余列为 -1。
+// 四个计数器作为一组打开，同时计数、同时被调度。PMU 计数器不够而被分时复用时，按实际计数时间的比例放大，
+// counter_coverage 列为计数时间占开启时间的最小比例，小于 1 表示结果经过放大，只是估计值。
+// 链表规模从 1K 个节点按 4 倍递增，依次越过 L1、L2、L3 进入内存；
+// 每个规模测试三种节点布局：sequential（按地址顺序链接）、shuffled（随机顺序链接）、
+// churned（顺序链接后再做 n 次随机 list_move，模拟长时间运行后的链表）。
+// 修改类操作对每个节点执行一次：list_cut_position 每次从表头切下一个节点，
+// list_splice 系列每次把一条只有一个节点的链表接到主链表上，list_replace 系列用上一个被替换下来的节点替换下一个节点。
+// -b 时每个节点带 8～120 字节的数据，分别测试建表、读取每个节点的数据、查找表尾的数据和释放，
+// 并输出建表时的内存分配次数：blob 从按大小分级的内存池中分配，指针设计每个节点要 malloc 节点和数据两次。
+// bytes 列对 blob 为内存池申请的内存块总大小，对指针设计为节点和数据的总大小（不含 malloc 自身的开销）。
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "list.h"
+#include "list_blob.h"
+
+typedef struct node
+{
+    int data;
+    struct list_head list;
+} listnode, *linklist;
+
+enum
+{
+    CNT_CYCLES,
+    CNT_CACHE_MISSES,
+    CNT_TLB_MISSES,
+    CNT_BRANCH_MISSES,
+    NR_COUNTERS,
+};
+
+enum
+{
+    LAYOUT_SEQUENTIAL,
+    LAYOUT_SHUFFLED,
+    LAYOUT_CHURNED,
+    NR_LAYOUTS,
+};
+
+static const char *layout_name[NR_LAYOUTS] = {"sequential", "shuffled", "churned"};
+
+// 一组性能计数器，fd 为 -1 表示该计数器不可用
+struct counters
+{
+    int fd[NR_COUNTERS];
+    long long value[NR_COUNTERS];
+    long long enabled[NR_COUNTERS]; // 计数器开启的时间
+    long long running[NR_COUNTERS]; // 计数器实际在 PMU 上计数的时间，被分时复用时小于 enabled
+    double ns;
+};
+
+// 测试用的链表：节点放在一块连续内存中，order 决定链接顺序
+struct bench_ctx
+{
+    listnode *nodes;         // n + 1 个节点，最后一个是 list_replace 用的备用节点
+    struct list_head *heads; // n 个表头，供 list_cut_position 和 list_splice 系列使用
+    size_t *order;
+    size_t n;
+    int layout;
+    struct list_head head;
+    unsigned int seed;
+};
+
+static volatile long sink; // 防止遍历被编译器优化掉
+static int json_output;
+static int first_record = 1;
+
+/// @brief 打开一个只统计用户态的性能计数器，读取时带上开启时间和实际计数时间
+/// @param type 计数器类型
+/// @param config 计数器配置
+/// @param group_fd 组长的文件描述符，为 -1 时自己作为组长
+/// @return 成功，返回文件描述符。失败，返回 -1。
+static int open_counter(unsigned int type, unsigned long long config, int group_fd)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+/// @brief 打开所有性能计数器
+/// @param c 指向计数器组的指针
+/// @return 可用的计数器个数
+static int counters_open(struct counters *c)
+{
+    static const struct
+    {
+        unsigned int type;
+        unsigned long long config;
+    } events[NR_COUNTERS] = {
+        [CNT_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        [CNT_CACHE_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        [CNT_TLB_MISSES] = {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        [CNT_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+    int leader = -1;
+    int nr = 0;
+
+    // 第一个打开成功的计数器作为组长，其余加入同一组；加不进组时单独打开，靠计数时间放大
+    for (int i = 0; i < NR_COUNTERS; i++)
+    {
+        c->fd[i] = open_counter(events[i].type, events[i].config, leader);
+        if (c->fd[i] < 0 && leader >= 0)
+        {
+            c->fd[i] = open_counter(events[i].type, events[i].config, -1);
+        }
+        else if (c->fd[i] >= 0 && leader < 0)
+        {
+            leader = c->fd[i];
+        }
+        if (c->fd[i] >= 0)
+        {
+            nr++;
+        }
+    }
+
+    return nr;
+}
+
+/// @brief 关闭所有性能计数器，组长最后关闭
+/// @param c 指向计数器组的指针
+static void counters_close(struct counters *c)
+{
+    for (int i = NR_COUNTERS - 1; i >= 0; i--)
+    {
+        if (c->fd[i] >= 0)
+        {
+            close(c->fd[i]);
+        }
+    }
+}
+
+/// @brief 获取单调时钟，单位纳秒
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/// @brief 清零并开始计数
+/// @param c 指向计数器组的指针
+static void counters_start(struct counters *c)
+{
+    for (int i = 0; i < NR_COUNTERS; i++)
+    {
+        c->value[i] = 0;
+        if (c->fd[i] >= 0)
+        {
+            ioctl(c->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    c->ns = now_ns();
+}
+
+/// @brief 停止计数，把计数值、开启时间和实际计数时间累加到 total
+/// @param c 指向计数器组的指针
+/// @param total 累加结果
+static void counters_stop(struct counters *c, struct counters *total)
+{
+    double end = now_ns();
+
+    for (int i = 0; i < NR_COUNTERS; i++)
+    {
+        if (c->fd[i] >= 0)
+        {
+            long long v[3]; // value、time_enabled、time_running
+            ioctl(c->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(c->fd[i], v, sizeof(v)) == sizeof(v))
+            {
+                total->value[i] += v[0];
+                total->enabled[i] += v[1];
+                total->running[i] += v[2];
+            }
+        }
+    }
+    total->ns += end - c->ns;
+}
+
+/// @brief 按布局重新链接所有节点
+/// @param ctx 测试上下文
+static void build_list(struct bench_ctx *ctx)
+{
+    INIT_LIST_HEAD(&ctx->head);
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_add_tail(&ctx->nodes[ctx->order[i]].list, &ctx->head);
+    }
+
+    if (ctx->layout == LAYOUT_CHURNED)
+    {
+        for (size_t i = 0; i < ctx->n; i++)
+        {
+            listnode *a = &ctx->nodes[rand_r(&ctx->seed) % ctx->n];
+            listnode *b = &ctx->nodes[rand_r(&ctx->seed) % ctx->n];
+            if (a != b)
+            {
+                list_move(&a->list, &b->list);
+            }
+        }
+    }
+}
+
+/// @brief 把每个节点放进各自的表头，组成 n 条只有一个节点的链表，主链表置空
+/// @param ctx 测试上下文
+static void build_singletons(struct bench_ctx *ctx)
+{
+    INIT_LIST_HEAD(&ctx->head);
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        INIT_LIST_HEAD(&ctx->heads[i]);
+        list_add(&ctx->nodes[ctx->order[i]].list, &ctx->heads[i]);
+    }
+}
+
+/// @brief 创建测试上下文
+/// @param n 节点个数
+/// @param layout 节点布局
+/// @return 成功，返回 0。失败，返回 -1。
+static int ctx_init(struct bench_ctx *ctx, size_t n, int layout)
+{
+    ctx->nodes = (listnode *)calloc(n + 1, sizeof(listnode));
+    ctx->heads = (struct list_head *)calloc(n, sizeof(struct list_head));
+    ctx->order = (size_t *)calloc(n, sizeof(size_t));
+    if (ctx->nodes == NULL || ctx->heads == NULL || ctx->order == NULL)
+    {
+        perror("calloc");
+        free(ctx->nodes);
+        free(ctx->heads);
+        free(ctx->order);
+        return -1;
+    }
+    ctx->n = n;
+    ctx->layout = layout;
+    ctx->seed = 12345;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        ctx->nodes[i].data = (int)i;
+        ctx->order[i] = i;
+    }
+    if (layout == LAYOUT_SHUFFLED)
+    {
+        for (size_t i = n - 1; i > 0; i--)
+        {
+            size_t j = ((size_t)rand_r(&ctx->seed) << 16 ^ rand_r(&ctx->seed)) % (i + 1);
+            size_t tmp = ctx->order[i];
+            ctx->order[i] = ctx->order[j];
+            ctx->order[j] = tmp;
+        }
+    }
+
+    return 0;
+}
+
+/// @brief 释放测试上下文
+static void ctx_exit(struct bench_ctx *ctx)
+{
+    free(ctx->nodes);
+    free(ctx->heads);
+    free(ctx->order);
+}
+
+/*
+ * 被测操作。遍历类操作在已建好的链表上执行，修改类操作对每个节点执行一次，
+ * 所以结果都可以按节点数平均。
+ */
+static void op_for_each(struct bench_ctx *ctx)
+{
+    struct list_head *pos;
+    long sum = 0;
+    list_for_each(pos, &ctx->head)
+    {
+        sum += (long)pos;
+    }
+    sink = sum;
+}
+
+static void op_for_each_prev(struct bench_ctx *ctx)
+{
+    struct list_head *pos;
+    long sum = 0;
+    list_for_each_prev(pos, &ctx->head)
+    {
+        sum += (long)pos;
+    }
+    sink = sum;
+}
+
+static void op_for_each_safe(struct bench_ctx *ctx)
+{
+    struct list_head *pos, *n;
+    long sum = 0;
+    list_for_each_safe(pos, n, &ctx->head)
+    {
+        sum += (long)pos;
+    }
+    sink = sum;
+}
+
+static void op_for_each_prev_safe(struct bench_ctx *ctx)
+{
+    struct list_head *pos, *n;
+    long sum = 0;
+    list_for_each_prev_safe(pos, n, &ctx->head)
+    {
+        sum += (long)pos;
+    }
+    sink = sum;
+}
+
+static void op_for_each_entry(struct bench_ctx *ctx)
+{
+    linklist pos;
+    long sum = 0;
+    list_for_each_entry(pos, &ctx->head, list)
+    {
+        sum += pos->data;
+    }
+    sink = sum;
+}
+
+static void op_for_each_entry_reverse(struct bench_ctx *ctx)
+{
+    linklist pos;
+    long sum = 0;
+    list_for_each_entry_reverse(pos, &ctx->head, list)
+    {
+        sum += pos->data;
+    }
+    sink = sum;
+}
+
+static void op_for_each_entry_safe(struct bench_ctx *ctx)
+{
+    linklist pos, n;
+    long sum = 0;
+    list_for_each_entry_safe(pos, n, &ctx->head, list)
+    {
+        sum += pos->data;
+    }
+    sink = sum;
+}
+
+static void op_for_each_entry_safe_reverse(struct bench_ctx *ctx)
+{
+    linklist pos, n;
+    long sum = 0;
+    list_for_each_entry_safe_reverse(pos, n, &ctx->head, list)
+    {
+        sum += pos->data;
+    }
+    sink = sum;
+}
+
+// continue 和 safe_continue 从表头对应的“节点”开始，与 list_prepare_entry(NULL, ...) 相同，遍历全部节点
+static void op_for_each_entry_continue(struct bench_ctx *ctx)
+{
+    linklist pos = list_entry(&ctx->head, listnode, list);
+    long sum = 0;
+    list_for_each_entry_continue(pos, &ctx->head, list)
+    {
+        sum += pos->data;
+    }
+    sink = sum;
+}
+
+static void op_for_each_entry_continue_reverse(struct bench_ctx *ctx)
+{
+    linklist pos = list_entry(&ctx->head, listnode, list);
+    long sum = 0;
+    list_for_each_entry_continue_reverse(pos, &ctx->head, list)
+    {
+        sum += pos->data;
+    }
+    sink = sum;
+}
+
+static void op_for_each_entry_from(struct bench_ctx *ctx)
+{
+    linklist pos = list_first_entry(&ctx->head, listnode, list);
+    long sum = 0;
+    list_for_each_entry_from(pos, &ctx->head, list)
+    {
+        sum += pos->data;
+    }
+    sink = sum;
+}
+
+static void op_for_each_entry_safe_continue(struct bench_ctx *ctx)
+{
+    linklist pos = list_entry(&ctx->head, listnode, list), n;
+    long sum = 0;
+    list_for_each_entry_safe_continue(pos, n, &ctx->head, list)
+    {
+        sum += pos->data;
+    }
+    sink = sum;
+}
+
+static void op_for_each_entry_safe_from(struct bench_ctx *ctx)
+{
+    linklist pos = list_first_entry(&ctx->head, listnode, list), n;
+    long sum = 0;
+    list_for_each_entry_safe_from(pos, n, &ctx->head, list)
+    {
+        sum += pos->data;
+    }
+    sink = sum;
+}
+
+static void op_add(struct bench_ctx *ctx)
+{
+    INIT_LIST_HEAD(&ctx->head);
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_add(&ctx->nodes[ctx->order[i]].list, &ctx->head);
+    }
+}
+
+static void op_add_tail(struct bench_ctx *ctx)
+{
+    INIT_LIST_HEAD(&ctx->head);
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_add_tail(&ctx->nodes[ctx->order[i]].list, &ctx->head);
+    }
+}
+
+static void op_del(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_del(&ctx->nodes[i].list);
+    }
+}
+
+static void op_del_init(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_del_init(&ctx->nodes[i].list);
+    }
+}
+
+static void op_move(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_move(&ctx->nodes[i].list, &ctx->head);
+    }
+}
+
+static void op_move_tail(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_move_tail(&ctx->nodes[i].list, &ctx->head);
+    }
+}
+
+static void op_replace(struct bench_ctx *ctx)
+{
+    listnode *spare = &ctx->nodes[ctx->n];
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_replace(&ctx->nodes[i].list, &spare->list);
+        spare = &ctx->nodes[i];
+    }
+}
+
+static void op_replace_init(struct bench_ctx *ctx)
+{
+    listnode *spare = &ctx->nodes[ctx->n];
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_replace_init(&ctx->nodes[i].list, &spare->list);
+        spare = &ctx->nodes[i];
+    }
+}
+
+// 转 n 次后回到原来的顺序，不需要重建链表
+static void op_rotate_left(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_rotate_left(&ctx->head);
+    }
+}
+
+static void op_cut_position(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_cut_position(&ctx->heads[i], &ctx->head, ctx->head.next);
+    }
+}
+
+static void op_splice(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_splice(&ctx->heads[i], &ctx->head);
+    }
+}
+
+static void op_splice_tail(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_splice_tail(&ctx->heads[i], &ctx->head);
+    }
+}
+
+static void op_splice_init(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_splice_init(&ctx->heads[i], &ctx->head);
+    }
+}
+
+static void op_splice_tail_init(struct bench_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_splice_tail_init(&ctx->heads[i], &ctx->head);
+    }
+}
+
+struct bench_op
+{
+    const char *name;
+    void (*func)(struct bench_ctx *ctx);
+    void (*setup)(struct bench_ctx *ctx); // 执行前准备链表，不计入测量，为 NULL 时不需要准备
+    int mutates;                          // 是否会破坏链表，是则每次重复前重新准备
+};
+
+static const struct bench_op bench_ops[] = {
+    {"list_for_each", op_for_each, build_list, 0},
+    {"list_for_each_prev", op_for_each_prev, build_list, 0},
+    {"list_for_each_safe", op_for_each_safe, build_list, 0},
+    {"list_for_each_prev_safe", op_for_each_prev_safe, build_list, 0},
+    {"list_for_each_entry", op_for_each_entry, build_list, 0},
+    {"list_for_each_entry_reverse", op_for_each_entry_reverse, build_list, 0},
+    {"list_for_each_entry_continue", op_for_each_entry_continue, build_list, 0},
+    {"list_for_each_entry_continue_reverse", op_for_each_entry_continue_reverse, build_list, 0},
+    {"list_for_each_entry_from", op_for_each_entry_from, build_list, 0},
+    {"list_for_each_entry_safe", op_for_each_entry_safe, build_list, 0},
+    {"list_for_each_entry_safe_continue", op_for_each_entry_safe_continue, build_list, 0},
+    {"list_for_each_entry_safe_from", op_for_each_entry_safe_from, build_list, 0},
+    {"list_for_each_entry_safe_reverse", op_for_each_entry_safe_reverse, build_list, 0},
+    {"list_add", op_add, NULL, 1},
+    {"list_add_tail", op_add_tail, NULL, 1},
+    {"list_del", op_del, build_list, 1},
+    {"list_del_init", op_del_init, build_list, 1},
+    {"list_replace", op_replace, build_list, 1},
+    {"list_replace_init", op_replace_init, build_list, 1},
+    {"list_move", op_move, build_list, 1},
+    {"list_move_tail", op_move_tail, build_list, 1},
+    {"list_rotate_left", op_rotate_left, build_list, 0},
+    {"list_cut_position", op_cut_position, build_list, 1},
+    {"list_splice", op_splice, build_singletons, 1},
+    {"list_splice_tail", op_splice_tail, build_singletons, 1},
+    {"list_splice_init", op_splice_init, build_singletons, 1},
+    {"list_splice_tail_init", op_splice_tail_init, build_singletons, 1},
+};
+
+/// @brief 输出一条结果
+/// @param op 操作名
+/// @param layout 节点布局
+/// @param n 节点个数
+/// @param bytes 节点占用的字节数
+/// @param allocs 建表时的内存分配次数，小于 0 时不输出这一列
+/// @param total 累计的计数结果
+/// @param c 计数器组，用于判断哪些计数器可用
+/// @param visits 累计访问的节点数
+static void print_record(const char *op, int layout, size_t n, size_t bytes, long allocs,
+                         struct counters *total, struct counters *c, double visits)
+{
+    double per_node[NR_COUNTERS];
+    double coverage = -1;
+    char extra[64] = "";
+
+    // 按实际计数时间的比例放大，从未被调度到的计数器视为不可用
+    for (int i = 0; i < NR_COUNTERS; i++)
+    {
+        per_node[i] = -1;
+        if (c->fd[i] >= 0 && total->running[i] > 0)
+        {
+            double ratio = (double)total->running[i] / total->enabled[i];
+            per_node[i] = total->value[i] / ratio / visits;
+            coverage = (coverage < 0 || ratio < coverage) ? ratio : coverage;
+        }
+    }
+
+    if (json_output)
+    {
+        if (allocs >= 0)
+        {
+            snprintf(extra, sizeof(extra), "\"allocations\": %ld, ", allocs);
+        }
+        printf("%s  {\"op\": \"%s\", \"layout\": \"%s\", \"nodes\": %zu, \"bytes\": %zu, %s"
+               "\"ns_per_node\": %.3f, \"cycles_per_node\": %.3f, \"cache_misses_per_node\": %.4f, "
+               "\"tlb_misses_per_node\": %.4f, \"branch_misses_per_node\": %.4f, \"counter_coverage\": %.3f}",
+               first_record ? "" : ",\n", op, layout_name[layout], n, bytes, extra,
+               total->ns / visits, per_node[CNT_CYCLES], per_node[CNT_CACHE_MISSES],
+               per_node[CNT_TLB_MISSES], per_node[CNT_BRANCH_MISSES], coverage);
+    }
+    else
+    {
+        if (allocs >= 0)
+        {
+            snprintf(extra, sizeof(extra), "%ld,", allocs);
+        }
+        printf("%s,%s,%zu,%zu,%s%.3f,%.3f,%.4f,%.4f,%.4f,%.3f\n",
+               op, layout_name[layout], n, bytes, extra,
+               total->ns / visits, per_node[CNT_CYCLES], per_node[CNT_CACHE_MISSES],
+               per_node[CNT_TLB_MISSES], per_node[CNT_BRANCH_MISSES], coverage);
+    }
+    first_record = 0;
+    fflush(stdout);
+}
+
+/// @brief 对一个规模和布局执行全部被测操作
+/// @param ctx 测试上下文
+/// @param c 计数器组
+/// @param min_visits 每个操作最少访问的节点数，小链表会重复多次
+static void run_ops(struct bench_ctx *ctx, struct counters *c, size_t min_visits)
+{
+    size_t reps = (min_visits + ctx->n - 1) / ctx->n;
+
+    for (size_t k = 0; k < sizeof(bench_ops) / sizeof(bench_ops[0]); k++)
+    {
+        const struct bench_op *op = &bench_ops[k];
+        struct counters total;
+
+        memset(&total, 0, sizeof(total));
+        for (size_t r = 0; r < reps; r++)
+        {
+            // 建链表不计入测量
+            if (op->setup != NULL && (r == 0 || op->mutates))
+            {
+                op->setup(ctx);
+            }
+            counters_start(c);
+            op->func(ctx);
+            counters_stop(c, &total);
+        }
+        print_record(op->name, ctx->layout, ctx->n, ctx->n * sizeof(listnode), -1, &total, c,
+                     (double)reps * ctx->n);
+    }
+}
+
+// 对照设计：节点只保存数据指针，数据单独分配
+typedef struct ptrnode
+{
+    struct list_head list;
+    size_t len;
+    unsigned char *data;
+} ptrnode;
+
+// 变长数据测试的上下文，两种设计使用相同的数据和链接顺序
+struct payload_ctx
+{
+    size_t n;
+    int layout;
+    unsigned char *payload; // 所有数据首尾相接
+    size_t *offset;         // 第 i 个数据在 payload 中的位置，offset[n] 为总长度
+    size_t *order;
+    struct list_head blob_head;
+    struct list_head ptr_head;
+    struct blob_arena arena;
+    bloblist *blobs; // 按创建顺序记录节点，重新链接时使用
+    ptrnode **ptrs;
+    unsigned int seed;
+};
+
+/// @brief 创建变长数据测试的上下文
+/// @return 成功，返回 0。失败，返回 -1。
+static int payload_init(struct payload_ctx *ctx, size_t n, int layout)
+{
+    // 先初始化内存池和表头，申请失败时 payload_exit 也能安全调用
+    memset(ctx, 0, sizeof(*ctx));
+    INIT_LIST_HEAD(&ctx->blob_head);
+    INIT_LIST_HEAD(&ctx->ptr_head);
+    blob_arena_init(&ctx->arena);
+    ctx->n = n;
+    ctx->layout = layout;
+    ctx->seed = 54321;
+    ctx->offset = (size_t *)malloc(sizeof(size_t) * (n + 1));
+    ctx->order = (size_t *)malloc(sizeof(size_t) * n);
+    ctx->blobs = (bloblist *)malloc(sizeof(bloblist) * n);
+    ctx->ptrs = (ptrnode **)malloc(sizeof(ptrnode *) * n);
+    ctx->payload = (unsigned char *)malloc(n * 120);
+    if (ctx->offset == NULL || ctx->order == NULL || ctx->blobs == NULL || ctx->ptrs == NULL ||
+        ctx->payload == NULL)
+    {
+        perror("malloc");
+        return -1;
+    }
+
+    ctx->offset[0] = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t len = 8 + rand_r(&ctx->seed) % 113;
+        for (size_t k = 0; k < len; k++)
+        {
+            ctx->payload[ctx->offset[i] + k] = (unsigned char)rand_r(&ctx->seed);
+        }
+        ctx->offset[i + 1] = ctx->offset[i] + len;
+        ctx->order[i] = i;
+    }
+    if (layout == LAYOUT_SHUFFLED)
+    {
+        for (size_t i = n - 1; i > 0; i--)
+        {
+            size_t j = ((size_t)rand_r(&ctx->seed) << 16 ^ rand_r(&ctx->seed)) % (i + 1);
+            size_t tmp = ctx->order[i];
+            ctx->order[i] = ctx->order[j];
+            ctx->order[j] = tmp;
+        }
+    }
+
+    return 0;
+}
+
+/// @brief 释放变长数据测试的上下文
+static void payload_exit(struct payload_ctx *ctx)
+{
+    blob_arena_destroy(&ctx->arena);
+    free(ctx->payload);
+    free(ctx->offset);
+    free(ctx->order);
+    free(ctx->blobs);
+    free(ctx->ptrs);
+}
+
+static void op_blob_build(struct payload_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        ctx->blobs[i] = blob_add_tail(&ctx->arena, &ctx->blob_head, ctx->payload + ctx->offset[i],
+                                      ctx->offset[i + 1] - ctx->offset[i]);
+    }
+}
+
+static void op_ptr_build(struct payload_ctx *ctx)
+{
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        size_t len = ctx->offset[i + 1] - ctx->offset[i];
+        ptrnode *node = (ptrnode *)malloc(sizeof(ptrnode));
+        node->data = (unsigned char *)malloc(len);
+        node->len = len;
+        memcpy(node->data, ctx->payload + ctx->offset[i], len);
+        list_add_tail(&node->list, &ctx->ptr_head);
+        ctx->ptrs[i] = node;
+    }
+}
+
+/// @brief 按布局重新链接两种设计的节点，不计入测量
+static void payload_relink(struct payload_ctx *ctx)
+{
+    INIT_LIST_HEAD(&ctx->blob_head);
+    INIT_LIST_HEAD(&ctx->ptr_head);
+    for (size_t i = 0; i < ctx->n; i++)
+    {
+        list_add_tail(&ctx->blobs[ctx->order[i]]->list, &ctx->blob_head);
+        list_add_tail(&ctx->ptrs[ctx->order[i]]->list, &ctx->ptr_head);
+    }
+}
+
+// 读取每个节点数据的首尾字节
+static void op_blob_scan(struct payload_ctx *ctx)
+{
+    bloblist pos;
+    long sum = 0;
+    list_for_each_entry(pos, &ctx->blob_head, list)
+    {
+        sum += pos->data[0] + pos->data[pos->len - 1];
+    }
+    sink = sum;
+}
+
+static void op_ptr_scan(struct payload_ctx *ctx)
+{
+    ptrnode *pos;
+    long sum = 0;
+    list_for_each_entry(pos, &ctx->ptr_head, list)
+    {
+        sum += pos->data[0] + pos->data[pos->len - 1];
+    }
+    sink = sum;
+}
+
+// 查找表尾节点的数据，需要遍历整条链表
+static void op_blob_find(struct payload_ctx *ctx)
+{
+    size_t last = ctx->order[ctx->n - 1];
+    sink = (long)blob_find(&ctx->blob_head, ctx->payload + ctx->offset[last],
+                           ctx->offset[last + 1] - ctx->offset[last]);
+}
+
+static void op_ptr_find(struct payload_ctx *ctx)
+{
+    size_t last = ctx->order[ctx->n - 1];
+    const unsigned char *data = ctx->payload + ctx->offset[last];
+    size_t len = ctx->offset[last + 1] - ctx->offset[last];
+    ptrnode *pos, *found = NULL;
+    list_for_each_entry(pos, &ctx->ptr_head, list)
+    {
+        if (pos->len == len && memcmp(pos->data, data, len) == 0)
+        {
+            found = pos;
+            break;
+        }
+    }
+    sink = (long)found;
+}
+
+static void op_blob_free(struct payload_ctx *ctx)
+{
+    blob_destroy_list(&ctx->arena, &ctx->blob_head);
+}
+
+static void op_ptr_free(struct payload_ctx *ctx)
+{
+    ptrnode *pos, *n;
+    list_for_each_entry_safe(pos, n, &ctx->ptr_head, list)
+    {
+        free(pos->data);
+        free(pos);
+    }
+    INIT_LIST_HEAD(&ctx->ptr_head);
+}
+
+/// @brief 对一个规模和布局执行变长数据的全部测试
+/// @param ctx 测试上下文
+/// @param c 计数器组
+/// @param min_visits 每个操作最少访问的节点数，小链表会重复多次
+static void run_payload_ops(struct payload_ctx *ctx, struct counters *c, size_t min_visits)
+{
+    static const char *names[] = {"blob_build", "ptr_build", "blob_scan", "ptr_scan",
+                                  "blob_find", "ptr_find", "blob_free", "ptr_free"};
+    static void (*const funcs[])(struct payload_ctx *ctx) = {
+        op_blob_build, op_ptr_build, op_blob_scan, op_ptr_scan,
+        op_blob_find, op_ptr_find, op_blob_free, op_ptr_free};
+    size_t reps = (min_visits + ctx->n - 1) / ctx->n;
+    struct counters total[8];
+    long allocs[2];
+    size_t bytes[2];
+
+    memset(total, 0, sizeof(total));
+    for (size_t r = 0; r < reps; r++)
+    {
+        for (int k = 0; k < 8; k++)
+        {
+            // 两种设计都建好后再按布局重新链接
+            if (k == 2)
+            {
+                payload_relink(ctx);
+            }
+            counters_start(c);
+            funcs[k](ctx);
+            counters_stop(c, &total[k]);
+        }
+        if (r == 0)
+        {
+            // 内存池第一次建表时申请内存块，之后复用空闲节点
+            allocs[0] = (long)ctx->arena.nr_chunks;
+            allocs[1] = 2 * (long)ctx->n;
+            bytes[0] = ctx->arena.nr_chunks * BLOB_CHUNK_SIZE;
+            bytes[1] = ctx->n * sizeof(ptrnode) + ctx->offset[ctx->n];
+        }
+    }
+
+    for (int k = 0; k < 8; k++)
+    {
+        print_record(names[k], ctx->layout, ctx->n, bytes[k % 2], allocs[k % 2], &total[k], c,
+                     (double)reps * ctx->n);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_nodes = (size_t)1 << 24;
+    size_t min_visits = (size_t)1 << 24;
+    struct counters c;
+    int payload = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "jbm:v:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            json_output = 1;
+            break;
+        case 'b':
+            payload = 1;
+            break;
+        case 'm':
+            max_nodes = strtoull(optarg, NULL, 0);
+            break;
+        case 'v':
+            min_visits = strtoull(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j] [-b] [-m max_nodes] [-v min_visits]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    if (counters_open(&c) == 0)
+    {
+        fprintf(stderr, "perf_event_open unavailable, reporting time only\n");
+    }
+
+    if (json_output)
+    {
+        printf("[\n");
+    }
+    else
+    {
+        printf("op,layout,nodes,bytes,%sns_per_node,cycles_per_node,cache_misses_per_node,"
+               "tlb_misses_per_node,branch_misses_per_node,counter_coverage\n", payload ? "allocations," : "");
+    }
+
+    for (size_t n = 1024; payload && n <= max_nodes; n *= 4)
+    {
+        // 变长数据只测顺序和乱序两种布局
+        for (int layout = LAYOUT_SEQUENTIAL; layout <= LAYOUT_SHUFFLED; layout++)
+        {
+            struct payload_ctx ctx;
+            if (payload_init(&ctx, n, layout) != 0)
+            {
+                payload_exit(&ctx);
+                counters_close(&c);
+                return -1;
+            }
+            run_payload_ops(&ctx, &c, min_visits);
+            payload_exit(&ctx);
+        }
+    }
+
+    for (size_t n = 1024; !payload && n <= max_nodes; n *= 4)
+    {
+        for (int layout = 0; layout < NR_LAYOUTS; layout++)
+        {
+            struct bench_ctx ctx;
+            if (ctx_init(&ctx, n, layout) != 0)
+            {
+                counters_close(&c);
+                return -1;
+            }
+            run_ops(&ctx, &c, min_visits);
+            ctx_exit(&ctx);
+        }
+    }
+
+    if (json_output)
+    {
+        printf("\n]\n");
+    }
+    counters_close(&c);
+
+    return 0;
+}
@@ -0,0 +1,280 @@
+#ifndef _LIST_QUEUE_H
+#define _LIST_QUEUE_H
+
+// 基于内核链表的阻塞队列
+// 消费者取不到数据时先自旋一会儿，再通过 futex 休眠，不再轮询 list_empty() 加 sleep。
+// 只有队列从空变为非空时生产者才去唤醒休眠的消费者；
+// 消费者取走一批后队列仍非空，再接力唤醒下一个休眠者。
+// list_queue_dequeue_batch 用 list_cut_position 一次摘下多个节点。
+
+#include <limits.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "list.h"
+
+#define LIST_QUEUE_SPIN 1000 // 休眠前的自旋次数
+
+// 阻塞队列
+struct list_queue
+{
+    struct list_head head;
+    int count;             // 队列中的节点数，受 lock 保护
+    int closed;            // 队列已关闭，受 lock 保护
+    atomic_int lock;       // 保护 head、count 和 closed 的自旋锁
+    atomic_int seq;        // futex 等待的字，队列每次由空变为非空时加一
+    atomic_int nr_waiters; // 正在 futex 上休眠的消费者数
+};
+
+/// @brief 初始化队列
+/// @param q 指向队列的指针
+static inline void list_queue_init(struct list_queue *q)
+{
+    INIT_LIST_HEAD(&q->head);
+    q->count = 0;
+    q->closed = 0;
+    atomic_init(&q->lock, 0);
+    atomic_init(&q->seq, 0);
+    atomic_init(&q->nr_waiters, 0);
+}
+
+static inline void __list_queue_lock(struct list_queue *q)
+{
+    while (atomic_exchange_explicit(&q->lock, 1, memory_order_acquire))
+    {
+        while (atomic_load_explicit(&q->lock, memory_order_relaxed))
+        {
+            sched_yield();
+        }
+    }
+}
+
+static inline void __list_queue_unlock(struct list_queue *q)
+{
+    atomic_store_explicit(&q->lock, 0, memory_order_release);
+}
+
+static inline void __list_queue_futex_wait(atomic_int *addr, int val)
+{
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static inline void __list_queue_futex_wake(atomic_int *addr, int nr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, nr, NULL, NULL, 0);
+}
+
+/// @brief 有消费者在休眠时唤醒其中 nr 个
+/// @param q 指向队列的指针
+/// @param nr 唤醒个数
+static inline void __list_queue_wake(struct list_queue *q, int nr)
+{
+    if (atomic_load(&q->nr_waiters) > 0)
+    {
+        __list_queue_futex_wake(&q->seq, nr);
+    }
+}
+
+/// @brief 入队一个节点
+/// @param q 指向队列的指针
+/// @param entry 要入队的节点
+static inline void list_queue_enqueue(struct list_queue *q, struct list_head *entry)
+{
+    int was_empty;
+
+    __list_queue_lock(q);
+    was_empty = list_empty(&q->head);
+    list_add_tail(entry, &q->head);
+    q->count++;
+    if (was_empty)
+    {
+        atomic_fetch_add(&q->seq, 1);
+    }
+    __list_queue_unlock(q);
+
+    if (was_empty)
+    {
+        __list_queue_wake(q, 1);
+    }
+}
+
+/// @brief 一次入队一整条链表
+/// @param q 指向队列的指针
+/// @param list 要入队的链表，入队后被重新初始化
+/// @param nr list 中的节点数
+static inline void list_queue_enqueue_list(struct list_queue *q, struct list_head *list, int nr)
+{
+    int was_empty;
+
+    if (list_empty(list))
+    {
+        return;
+    }
+
+    __list_queue_lock(q);
+    was_empty = list_empty(&q->head);
+    list_splice_tail_init(list, &q->head);
+    q->count += nr;
+    if (was_empty)
+    {
+        atomic_fetch_add(&q->seq, 1);
+    }
+    __list_queue_unlock(q);
+
+    if (was_empty)
+    {
+        __list_queue_wake(q, 1);
+    }
+}
+
+/// @brief 在持有锁的情况下从队头摘下最多 n 个节点，放到 list 的队尾
+/// @param q 指向队列的指针
+/// @param list 接收节点的链表
+/// @param n 最多摘下的节点数
+/// @return 摘下的节点数
+static inline int __list_queue_take(struct list_queue *q, struct list_head *list, int n)
+{
+    LIST_HEAD(batch);
+    struct list_head *entry;
+
+    if (n >= q->count)
+    {
+        n = q->count;
+        list_splice_tail_init(&q->head, list);
+    }
+    else
+    {
+        entry = q->head.next;
+        for (int i = 1; i < n; i++)
+        {
+            entry = entry->next;
+        }
+        list_cut_position(&batch, &q->head, entry);
+        list_splice_tail(&batch, list);
+    }
+    q->count -= n;
+
+    return n;
+}
+
+/// @brief 不阻塞地出队最多 n 个节点
+/// @param q 指向队列的指针
+/// @param list 接收节点的链表，节点追加在它的队尾
+/// @param n 最多出队的节点数
+/// @return 出队的节点数，队列为空时返回 0
+static inline int list_queue_try_dequeue_batch(struct list_queue *q, struct list_head *list, int n)
+{
+    int got = 0;
+    int more;
+
+    if (n <= 0)
+    {
+        return 0;
+    }
+
+    __list_queue_lock(q);
+    if (q->count > 0)
+    {
+        got = __list_queue_take(q, list, n);
+    }
+    more = q->count > 0;
+    __list_queue_unlock(q);
+
+    if (got > 0 && more)
+    {
+        __list_queue_wake(q, 1);
+    }
+
+    return got;
+}
+
+/// @brief 出队最多 n 个节点，队列为空时先自旋再休眠等待
+/// @param q 指向队列的指针
+/// @param list 接收节点的链表，节点追加在它的队尾
+/// @param n 最多出队的节点数
+/// @return 出队的节点数。队列已关闭且为空时返回 0
+static inline int list_queue_dequeue_batch(struct list_queue *q, struct list_head *list, int n)
+{
+    int got, more, seq, spins;
+
+    if (n <= 0)
+    {
+        return 0;
+    }
+
+    while (1)
+    {
+        __list_queue_lock(q);
+        if (q->count > 0)
+        {
+            got = __list_queue_take(q, list, n);
+            more = q->count > 0;
+            __list_queue_unlock(q);
+            // 队列里还有剩余，接力唤醒下一个休眠的消费者
+            if (more)
+            {
+                __list_queue_wake(q, 1);
+            }
+            return got;
+        }
+        if (q->closed)
+        {
+            __list_queue_unlock(q);
+            return 0;
+        }
+        seq = atomic_load(&q->seq);
+        __list_queue_unlock(q);
+
+        // 先自旋等待 seq 变化，避免短暂空队列时的休眠和唤醒开销
+        for (spins = 0; spins < LIST_QUEUE_SPIN; spins++)
+        {
+            if (atomic_load_explicit(&q->seq, memory_order_relaxed) != seq)
+            {
+                break;
+            }
+        }
+        if (spins < LIST_QUEUE_SPIN)
+        {
+            continue;
+        }
+
+        // 先登记再休眠，seq 已经变化时 futex 会立即返回
+        atomic_fetch_add(&q->nr_waiters, 1);
+        __list_queue_futex_wait(&q->seq, seq);
+        atomic_fetch_sub(&q->nr_waiters, 1);
+    }
+}
+
+/// @brief 出队一个节点，队列为空时阻塞
+/// @param q 指向队列的指针
+/// @return 成功，返回出队的节点。队列已关闭且为空时返回 NULL
+static inline struct list_head *list_queue_dequeue(struct list_queue *q)
+{
+    LIST_HEAD(list);
+
+    if (list_queue_dequeue_batch(q, &list, 1) == 0)
+    {
+        return NULL;
+    }
+
+    struct list_head *entry = list.next;
+    list_del_init(entry);
+    return entry;
+}
+
+/// @brief 关闭队列并唤醒所有消费者，之后取空队列的消费者返回 0
+/// @param q 指向队列的指针
+static inline void list_queue_close(struct list_queue *q)
+{
+    __list_queue_lock(q);
+    q->closed = 1;
+    atomic_fetch_add(&q->seq, 1);
+    __list_queue_unlock(q);
+
+    __list_queue_futex_wake(&q->seq, INT_MAX);
+}
+
+#endif
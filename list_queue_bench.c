@@ -0,0 +1,399 @@
+// list_queue.h 的正确性检查和交接延迟测试
+// 编译：gcc -O2 -o list_queue_bench list_queue_bench.c -lpthread
+// 用法：./list_queue_bench [-j] [-n 每个生产者的数据个数] [-b 每次最多出队个数] [-g 生产间隔（纳秒）]
+//   -j  输出 JSON，默认输出 CSV
+// 先用 3 个生产者、4 个消费者检查每个数据恰好被取出一次，失败时返回 -1。
+// 再对比 futex 队列和基于 pthread 条件变量的队列：数据入队时记下时间，出队时计算交接延迟，
+// 输出 p50、p99、p999 和最大值。paced 模式下生产者每次入队后忙等一段时间，消费者经常要休眠再被唤醒；
+// burst 模式下生产者连续入队。
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <getopt.h>
+
+#include "list_queue.h"
+
+enum
+{
+    QUEUE_FUTEX,
+    QUEUE_CONDVAR,
+    NR_QUEUES,
+};
+
+static const char *queue_name[NR_QUEUES] = {"futex", "condvar"};
+
+// 队列中传递的数据
+struct item
+{
+    struct list_head list;
+    long long ts; // 入队时间，单位纳秒
+    long id;
+};
+
+// 对照：基于条件变量的队列，每次入队都 signal
+struct cond_queue
+{
+    struct list_head head;
+    int closed;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+};
+
+// 一轮测试的共享状态
+struct bench
+{
+    int kind;
+    struct list_queue q;
+    struct cond_queue cq;
+    struct item *items;
+    long nr_per_producer;
+    int batch;
+    long gap_ns;
+    unsigned int *latency; // 按数据 id 记录交接延迟，单位纳秒
+    atomic_int *seen;      // 按数据 id 记录被取出的次数
+};
+
+// 生产者参数
+struct producer
+{
+    pthread_t tid;
+    struct bench *b;
+    int index;
+};
+
+/// @brief 获取单调时钟，单位纳秒
+static long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void cond_queue_init(struct cond_queue *cq)
+{
+    INIT_LIST_HEAD(&cq->head);
+    cq->closed = 0;
+    pthread_mutex_init(&cq->lock, NULL);
+    pthread_cond_init(&cq->cond, NULL);
+}
+
+static void cond_queue_exit(struct cond_queue *cq)
+{
+    pthread_mutex_destroy(&cq->lock);
+    pthread_cond_destroy(&cq->cond);
+}
+
+static void cond_queue_enqueue(struct cond_queue *cq, struct list_head *entry)
+{
+    pthread_mutex_lock(&cq->lock);
+    list_add_tail(entry, &cq->head);
+    pthread_cond_signal(&cq->cond);
+    pthread_mutex_unlock(&cq->lock);
+}
+
+/// @brief 出队最多 n 个节点，队列为空时等待。队列已关闭且为空时返回 0
+static int cond_queue_dequeue_batch(struct cond_queue *cq, struct list_head *list, int n)
+{
+    int got = 0;
+
+    pthread_mutex_lock(&cq->lock);
+    while (list_empty(&cq->head) && !cq->closed)
+    {
+        pthread_cond_wait(&cq->cond, &cq->lock);
+    }
+    while (got < n && !list_empty(&cq->head))
+    {
+        list_move_tail(cq->head.next, list);
+        got++;
+    }
+    pthread_mutex_unlock(&cq->lock);
+
+    return got;
+}
+
+static void cond_queue_close(struct cond_queue *cq)
+{
+    pthread_mutex_lock(&cq->lock);
+    cq->closed = 1;
+    pthread_cond_broadcast(&cq->cond);
+    pthread_mutex_unlock(&cq->lock);
+}
+
+/// @brief 生产者：依次入队自己的数据，入队后忙等 gap_ns
+static void *producer_main(void *arg)
+{
+    struct producer *p = arg;
+    struct bench *b = p->b;
+    struct item *items = &b->items[p->index * b->nr_per_producer];
+
+    for (long i = 0; i < b->nr_per_producer; i++)
+    {
+        items[i].ts = now_ns();
+        if (b->kind == QUEUE_FUTEX)
+        {
+            list_queue_enqueue(&b->q, &items[i].list);
+        }
+        else
+        {
+            cond_queue_enqueue(&b->cq, &items[i].list);
+        }
+        if (b->gap_ns > 0)
+        {
+            long long until = now_ns() + b->gap_ns;
+            while (now_ns() < until)
+            {
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief 消费者：批量出队，记录交接延迟和取出次数，直到队列关闭
+static void *consumer_main(void *arg)
+{
+    struct bench *b = arg;
+
+    while (1)
+    {
+        LIST_HEAD(batch);
+        struct item *pos;
+        int got;
+
+        if (b->kind == QUEUE_FUTEX)
+        {
+            got = list_queue_dequeue_batch(&b->q, &batch, b->batch);
+        }
+        else
+        {
+            got = cond_queue_dequeue_batch(&b->cq, &batch, b->batch);
+        }
+        if (got == 0)
+        {
+            return NULL;
+        }
+
+        long long now = now_ns();
+        list_for_each_entry(pos, &batch, list)
+        {
+            b->latency[pos->id] = (unsigned int)(now - pos->ts);
+            atomic_fetch_add(&b->seen[pos->id], 1);
+        }
+    }
+}
+
+/// @brief 执行一轮测试
+/// @param b 共享状态
+/// @param nr_producers 生产者个数
+/// @param nr_consumers 消费者个数
+/// @return 成功，返回耗时（纳秒）。失败，返回 -1。
+static double run_bench(struct bench *b, int nr_producers, int nr_consumers)
+{
+    struct producer producers[nr_producers];
+    pthread_t consumers[nr_consumers];
+    long total = nr_producers * b->nr_per_producer;
+    long long start, end;
+
+    list_queue_init(&b->q);
+    cond_queue_init(&b->cq);
+    for (long i = 0; i < total; i++)
+    {
+        b->items[i].id = i;
+        atomic_init(&b->seen[i], 0);
+    }
+
+    start = now_ns();
+    for (int i = 0; i < nr_consumers; i++)
+    {
+        if (pthread_create(&consumers[i], NULL, consumer_main, b) != 0)
+        {
+            perror("pthread_create");
+            return -1;
+        }
+    }
+    for (int i = 0; i < nr_producers; i++)
+    {
+        producers[i].b = b;
+        producers[i].index = i;
+        if (pthread_create(&producers[i].tid, NULL, producer_main, &producers[i]) != 0)
+        {
+            perror("pthread_create");
+            return -1;
+        }
+    }
+    for (int i = 0; i < nr_producers; i++)
+    {
+        pthread_join(producers[i].tid, NULL);
+    }
+    // 关闭后消费者取完剩余数据才退出
+    if (b->kind == QUEUE_FUTEX)
+    {
+        list_queue_close(&b->q);
+    }
+    else
+    {
+        cond_queue_close(&b->cq);
+    }
+    for (int i = 0; i < nr_consumers; i++)
+    {
+        pthread_join(consumers[i], NULL);
+    }
+    end = now_ns();
+    cond_queue_exit(&b->cq);
+
+    return end - start;
+}
+
+/// @brief 检查每个数据恰好被取出一次
+/// @return 全部正确，返回 0。否则返回 -1。
+static int check_seen(struct bench *b, long total)
+{
+    for (long i = 0; i < total; i++)
+    {
+        int n = atomic_load(&b->seen[i]);
+        if (n != 1)
+        {
+            fprintf(stderr, "%s queue: item %ld dequeued %d time(s)\n", queue_name[b->kind], i, n);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int cmp_uint(const void *a, const void *b)
+{
+    unsigned int x = *(const unsigned int *)a;
+    unsigned int y = *(const unsigned int *)b;
+
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[])
+{
+    static const int shapes[][2] = {{1, 1}, {1, 4}, {4, 1}, {4, 4}}; // 生产者、消费者个数
+    static const char *pattern_name[] = {"paced", "burst"};
+    long nr_per_producer = 20000;
+    long paced_gap = 10000;
+    int batch = 16;
+    int json_output = 0;
+    int first_record = 1;
+    struct bench b;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "jn:b:g:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            json_output = 1;
+            break;
+        case 'n':
+            nr_per_producer = atol(optarg);
+            break;
+        case 'b':
+            batch = atoi(optarg);
+            break;
+        case 'g':
+            paced_gap = atol(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j] [-n items_per_producer] [-b batch] [-g gap_ns]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (nr_per_producer <= 0 || batch <= 0 || paced_gap < 0)
+    {
+        fprintf(stderr, "invalid argument\n");
+        return -1;
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.nr_per_producer = nr_per_producer;
+    b.batch = batch;
+    b.items = (struct item *)calloc(4 * nr_per_producer, sizeof(struct item));
+    b.latency = (unsigned int *)calloc(4 * nr_per_producer, sizeof(unsigned int));
+    b.seen = (atomic_int *)calloc(4 * nr_per_producer, sizeof(atomic_int));
+    if (b.items == NULL || b.latency == NULL || b.seen == NULL)
+    {
+        perror("calloc");
+        return -1;
+    }
+
+    // 3 个生产者、4 个消费者，连续入队，检查每个数据恰好被取出一次
+    for (int kind = 0; kind < NR_QUEUES; kind++)
+    {
+        b.kind = kind;
+        b.gap_ns = 0;
+        if (run_bench(&b, 3, 4) < 0 || check_seen(&b, 3 * nr_per_producer) != 0)
+        {
+            return -1;
+        }
+    }
+    fprintf(stderr, "3 producers / 4 consumers: every item dequeued exactly once\n");
+
+    if (json_output)
+    {
+        printf("[\n");
+    }
+    else
+    {
+        printf("queue,pattern,producers,consumers,items,items_per_sec,p50_ns,p99_ns,p999_ns,max_ns\n");
+    }
+
+    for (int pattern = 0; pattern < 2; pattern++)
+    {
+        for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++)
+        {
+            int nr_producers = shapes[s][0];
+            int nr_consumers = shapes[s][1];
+            long total = nr_producers * nr_per_producer;
+
+            for (int kind = 0; kind < NR_QUEUES; kind++)
+            {
+                b.kind = kind;
+                b.gap_ns = pattern == 0 ? paced_gap : 0;
+                double ns = run_bench(&b, nr_producers, nr_consumers);
+                if (ns < 0 || check_seen(&b, total) != 0)
+                {
+                    return -1;
+                }
+
+                qsort(b.latency, total, sizeof(unsigned int), cmp_uint);
+                double rate = total / (ns / 1e9);
+                unsigned int p50 = b.latency[total * 50 / 100];
+                unsigned int p99 = b.latency[total * 99 / 100];
+                unsigned int p999 = b.latency[total * 999 / 1000];
+                unsigned int max = b.latency[total - 1];
+
+                if (json_output)
+                {
+                    printf("%s  {\"queue\": \"%s\", \"pattern\": \"%s\", \"producers\": %d, \"consumers\": %d, "
+                           "\"items\": %ld, \"items_per_sec\": %.0f, \"p50_ns\": %u, \"p99_ns\": %u, "
+                           "\"p999_ns\": %u, \"max_ns\": %u}",
+                           first_record ? "" : ",\n", queue_name[kind], pattern_name[pattern],
+                           nr_producers, nr_consumers, total, rate, p50, p99, p999, max);
+                }
+                else
+                {
+                    printf("%s,%s,%d,%d,%ld,%.0f,%u,%u,%u,%u\n", queue_name[kind], pattern_name[pattern],
+                           nr_producers, nr_consumers, total, rate, p50, p99, p999, max);
+                }
+                first_record = 0;
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (json_output)
+    {
+        printf("\n]\n");
+    }
+    free(b.items);
+    free(b.latency);
+    free(b.seen);
+
+    return 0;
+}
@@ -0,0 +1,219 @@
+// ws_pool.h 的 fork/join 扩展性测试
+// 编译：gcc -O2 -o ws_bench ws_bench.c -lpthread
+// 用法：./ws_bench [-j] [-n fib 参数] [-c 串行阈值] [-t 最大线程数] [-r 重复次数]
+//   -j  输出 JSON，默认输出 CSV
+// 用递归 fib 构造 fork/join 任务树：每个任务提交两个子任务再 ws_pool_join，参数小于阈值时串行计算。
+// 线程数从 1 开始按 2 倍递增，最后一项为最大线程数（默认在线 CPU 数），
+// 每个线程数取多次运行中最快的一次，输出耗时、每秒任务数、相对单线程的加速比和并行效率。
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "ws_pool.h"
+
+// fib 任务，子任务的结果写回自己的 result，完成后把父任务的计数器减一
+struct fib_task
+{
+    struct ws_task task;
+    int n;
+    long result;
+    atomic_long *parent;
+};
+
+static struct ws_pool *pool;
+static int cutoff = 18;
+static atomic_long nr_tasks;
+
+/// @brief 获取单调时钟，单位纳秒
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/// @brief 串行计算 fib
+static long fib_serial(int n)
+{
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+/// @brief fib 任务函数：fork 两个子任务，join 后合并结果
+static void fib_func(struct ws_task *task)
+{
+    struct fib_task *t = list_entry(task, struct fib_task, task);
+
+    atomic_fetch_add_explicit(&nr_tasks, 1, memory_order_relaxed);
+    if (t->n < cutoff)
+    {
+        t->result = fib_serial(t->n);
+    }
+    else
+    {
+        atomic_long children = 2;
+        struct fib_task a = {.n = t->n - 1, .parent = &children};
+        struct fib_task b = {.n = t->n - 2, .parent = &children};
+
+        ws_task_init(&a.task, fib_func);
+        ws_task_init(&b.task, fib_func);
+        ws_pool_submit(pool, &a.task);
+        ws_pool_submit(pool, &b.task);
+        ws_pool_join(pool, &children);
+        t->result = a.result + b.result;
+    }
+    if (t->parent != NULL)
+    {
+        atomic_fetch_sub(t->parent, 1);
+    }
+}
+
+/// @brief 用指定线程数计算一次 fib
+/// @param nr_threads 工作线程数
+/// @param n fib 参数
+/// @param result 计算结果
+/// @return 成功，返回耗时（纳秒）。失败，返回 -1。
+static double run_fib(int nr_threads, int n, long *result)
+{
+    struct fib_task root = {.n = n, .parent = NULL};
+    double start, end;
+
+    pool = ws_pool_create(nr_threads);
+    if (pool == NULL)
+    {
+        return -1;
+    }
+    atomic_store(&nr_tasks, 0);
+    ws_task_init(&root.task, fib_func);
+
+    start = now_ns();
+    ws_pool_submit(pool, &root.task);
+    ws_pool_wait(pool);
+    end = now_ns();
+
+    ws_pool_destroy(pool);
+    *result = root.result;
+
+    return end - start;
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 36;
+    int max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int reps = 3;
+    int json_output = 0;
+    int first_record = 1;
+    double base_ns = 0;
+    long expect;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "jn:c:t:r:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            json_output = 1;
+            break;
+        case 'n':
+            n = atoi(optarg);
+            break;
+        case 'c':
+            cutoff = atoi(optarg);
+            break;
+        case 't':
+            max_threads = atoi(optarg);
+            break;
+        case 'r':
+            reps = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j] [-n fib] [-c cutoff] [-t max_threads] [-r reps]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (max_threads <= 0)
+    {
+        max_threads = 1;
+    }
+    if (cutoff < 2)
+    {
+        cutoff = 2;
+    }
+    if (reps <= 0)
+    {
+        reps = 1;
+    }
+
+    expect = fib_serial(n);
+    if (json_output)
+    {
+        printf("[\n");
+    }
+    else
+    {
+        printf("threads,fib,cutoff,tasks,ms,tasks_per_sec,speedup,efficiency\n");
+    }
+
+    for (int threads = 1;; threads *= 2)
+    {
+        if (threads > max_threads)
+        {
+            threads = max_threads;
+        }
+        double best = -1;
+        long result = 0;
+
+        for (int r = 0; r < reps; r++)
+        {
+            double ns = run_fib(threads, n, &result);
+            if (ns < 0)
+            {
+                return -1;
+            }
+            if (result != expect)
+            {
+                fprintf(stderr, "fib(%d) = %ld with %d threads, expected %ld\n", n, result, threads, expect);
+                return -1;
+            }
+            if (best < 0 || ns < best)
+            {
+                best = ns;
+            }
+        }
+        if (threads == 1)
+        {
+            base_ns = best;
+        }
+
+        long tasks = atomic_load(&nr_tasks);
+        double speedup = base_ns / best;
+        if (json_output)
+        {
+            printf("%s  {\"threads\": %d, \"fib\": %d, \"cutoff\": %d, \"tasks\": %ld, \"ms\": %.3f, "
+                   "\"tasks_per_sec\": %.0f, \"speedup\": %.3f, \"efficiency\": %.3f}",
+                   first_record ? "" : ",\n", threads, n, cutoff, tasks, best / 1e6,
+                   tasks / (best / 1e9), speedup, speedup / threads);
+        }
+        else
+        {
+            printf("%d,%d,%d,%ld,%.3f,%.0f,%.3f,%.3f\n", threads, n, cutoff, tasks, best / 1e6,
+                   tasks / (best / 1e9), speedup, speedup / threads);
+        }
+        first_record = 0;
+        fflush(stdout);
+
+        if (threads == max_threads)
+        {
+            break;
+        }
+    }
+
+    if (json_output)
+    {
+        printf("\n]\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,375 @@
+#ifndef _WS_POOL_H
+#define _WS_POOL_H
+
+// 基于内核链表的工作窃取线程池
+// 每个工作线程拥有一个双端队列，队列直接由任务内嵌的 struct list_head 串起来，入队出队不需要额外分配内存。
+// 线程自身从队尾压入/弹出任务（LIFO），窃取者用 list_cut_position 一次性拿走受害者队头的一半任务（FIFO）。
+// 没有任务可做的线程会在条件变量上休眠，有新任务提交时才被唤醒。
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "list.h"
+
+struct ws_pool;
+
+// 任务结构，使用时内嵌到自己的任务结构体中，再用 list_entry 取回外层结构
+struct ws_task
+{
+    struct list_head list;
+    void (*func)(struct ws_task *task);
+};
+
+// 工作线程
+struct ws_worker
+{
+    pthread_mutex_t lock;   // 保护 deque 和 count
+    struct list_head deque; // 双端队列，队尾归线程自己，队头给窃取者
+    int count;              // 队列中的任务数
+    int id;
+    unsigned int seed; // 随机选择受害者用
+    pthread_t tid;
+    struct ws_pool *pool;
+};
+
+// 线程池
+struct ws_pool
+{
+    struct ws_worker *workers;
+    int nr_workers;
+    atomic_int next;     // 外部提交任务时轮流选择的工作线程
+    atomic_long queued;  // 所有队列中尚未取出的任务数
+    atomic_long pending; // 已提交但尚未执行完的任务数
+    atomic_int nr_parked;
+    atomic_int stop;
+    pthread_mutex_t park_lock;
+    pthread_cond_t park_cond; // 空闲线程在此休眠
+    pthread_cond_t done_cond; // ws_pool_wait 在此等待
+};
+
+// 当前线程所属的工作线程，非工作线程为 NULL
+static __thread struct ws_worker *ws_self;
+
+/// @brief 初始化任务
+/// @param task 指向任务的指针
+/// @param func 任务函数
+static inline void ws_task_init(struct ws_task *task, void (*func)(struct ws_task *task))
+{
+    INIT_LIST_HEAD(&task->list);
+    task->func = func;
+}
+
+/// @brief 唤醒一个休眠的工作线程
+/// @param pool 指向线程池的指针
+static inline void __ws_wake_one(struct ws_pool *pool)
+{
+    if (atomic_load(&pool->nr_parked) > 0)
+    {
+        pthread_mutex_lock(&pool->park_lock);
+        pthread_cond_signal(&pool->park_cond);
+        pthread_mutex_unlock(&pool->park_lock);
+    }
+}
+
+/// @brief 把任务压入指定工作线程的队尾
+/// @param w 指向工作线程的指针
+/// @param task 指向任务的指针
+static inline void __ws_push(struct ws_worker *w, struct ws_task *task)
+{
+    pthread_mutex_lock(&w->lock);
+    list_add_tail(&task->list, &w->deque);
+    w->count++;
+    pthread_mutex_unlock(&w->lock);
+}
+
+/// @brief 从自己的队尾弹出一个任务
+/// @param w 指向工作线程的指针
+/// @return 成功，返回指向任务的指针。队列为空，返回 NULL。
+static inline struct ws_task *__ws_pop(struct ws_worker *w)
+{
+    struct ws_task *task = NULL;
+
+    pthread_mutex_lock(&w->lock);
+    if (!list_empty(&w->deque))
+    {
+        task = list_last_entry(&w->deque, struct ws_task, list);
+        list_del_init(&task->list);
+        w->count--;
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    return task;
+}
+
+/// @brief 从受害者队头窃取一半任务，放进自己的队列
+/// @param self 指向窃取者的指针
+/// @param victim 指向受害者的指针
+/// @return 成功，返回其中一个可以立即执行的任务。受害者队列为空，返回 NULL。
+static inline struct ws_task *__ws_steal(struct ws_worker *self, struct ws_worker *victim)
+{
+    LIST_HEAD(stolen);
+    struct list_head *cut;
+    struct ws_task *task;
+    int nr, i;
+
+    pthread_mutex_lock(&victim->lock);
+    if (victim->count == 0)
+    {
+        pthread_mutex_unlock(&victim->lock);
+        return NULL;
+    }
+    // 拿走 (count + 1) / 2 个任务，只剩一个时也能偷走
+    nr = (victim->count + 1) / 2;
+    cut = victim->deque.next;
+    for (i = 1; i < nr; i++)
+    {
+        cut = cut->next;
+    }
+    list_cut_position(&stolen, &victim->deque, cut);
+    victim->count -= nr;
+    pthread_mutex_unlock(&victim->lock);
+
+    // 最老的任务留给自己马上执行，其余的放进自己的队列
+    task = list_first_entry(&stolen, struct ws_task, list);
+    list_del_init(&task->list);
+    if (--nr > 0)
+    {
+        pthread_mutex_lock(&self->lock);
+        list_splice_tail(&stolen, &self->deque);
+        self->count += nr;
+        pthread_mutex_unlock(&self->lock);
+    }
+
+    return task;
+}
+
+/// @brief 取一个可执行的任务，先查自己的队列，再随机窃取其他线程
+/// @param self 指向工作线程的指针
+/// @return 成功，返回指向任务的指针。没有任务可做，返回 NULL。
+static inline struct ws_task *__ws_get_task(struct ws_worker *self)
+{
+    struct ws_pool *pool = self->pool;
+    struct ws_task *task;
+    int start, i;
+
+    task = __ws_pop(self);
+    if (task == NULL && pool->nr_workers > 1)
+    {
+        start = rand_r(&self->seed) % pool->nr_workers;
+        for (i = 0; i < pool->nr_workers && task == NULL; i++)
+        {
+            struct ws_worker *victim = &pool->workers[(start + i) % pool->nr_workers];
+            if (victim != self)
+            {
+                task = __ws_steal(self, victim);
+            }
+        }
+    }
+    if (task != NULL)
+    {
+        atomic_fetch_sub(&pool->queued, 1);
+    }
+
+    return task;
+}
+
+/// @brief 执行任务，并在全部任务完成时通知 ws_pool_wait
+/// @param pool 指向线程池的指针
+/// @param task 指向任务的指针
+static inline void __ws_run(struct ws_pool *pool, struct ws_task *task)
+{
+    task->func(task);
+    if (atomic_fetch_sub(&pool->pending, 1) == 1)
+    {
+        pthread_mutex_lock(&pool->park_lock);
+        pthread_cond_broadcast(&pool->done_cond);
+        pthread_mutex_unlock(&pool->park_lock);
+    }
+}
+
+/// @brief 工作线程主循环
+/// @param arg 指向工作线程的指针
+static void *__ws_worker_main(void *arg)
+{
+    struct ws_worker *self = arg;
+    struct ws_pool *pool = self->pool;
+    struct ws_task *task;
+
+    ws_self = self;
+    while (!atomic_load(&pool->stop))
+    {
+        task = __ws_get_task(self);
+        if (task != NULL)
+        {
+            __ws_run(pool, task);
+            continue;
+        }
+
+        // 没有任务可做，休眠。先登记 nr_parked 再检查 queued，避免错过提交者的唤醒
+        pthread_mutex_lock(&pool->park_lock);
+        atomic_fetch_add(&pool->nr_parked, 1);
+        while (atomic_load(&pool->queued) == 0 && !atomic_load(&pool->stop))
+        {
+            pthread_cond_wait(&pool->park_cond, &pool->park_lock);
+        }
+        atomic_fetch_sub(&pool->nr_parked, 1);
+        pthread_mutex_unlock(&pool->park_lock);
+    }
+
+    return NULL;
+}
+
+/// @brief 提交任务。在工作线程内提交时压入自己的队列，否则轮流分给各工作线程
+/// @param pool 指向线程池的指针
+/// @param task 指向任务的指针
+static inline void ws_pool_submit(struct ws_pool *pool, struct ws_task *task)
+{
+    struct ws_worker *w = ws_self;
+
+    if (w == NULL || w->pool != pool)
+    {
+        w = &pool->workers[(unsigned int)atomic_fetch_add(&pool->next, 1) % pool->nr_workers];
+    }
+    atomic_fetch_add(&pool->pending, 1);
+    __ws_push(w, task);
+    atomic_fetch_add(&pool->queued, 1);
+    __ws_wake_one(pool);
+}
+
+/// @brief fork/join 中的 join：等待计数器归零，等待期间当前线程帮忙执行其他任务
+/// @param pool 指向线程池的指针
+/// @param counter 指向子任务计数器的指针，子任务完成时自行减一
+/// @note 在工作线程中调用不会阻塞该线程，在其他线程中调用则让出 CPU 等待。
+static inline void ws_pool_join(struct ws_pool *pool, atomic_long *counter)
+{
+    struct ws_worker *self = ws_self;
+    struct ws_task *task;
+
+    while (atomic_load(counter) > 0)
+    {
+        task = (self != NULL && self->pool == pool) ? __ws_get_task(self) : NULL;
+        if (task != NULL)
+        {
+            __ws_run(pool, task);
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+}
+
+/// @brief 等待所有已提交的任务执行完毕
+/// @param pool 指向线程池的指针
+/// @note 不能在工作线程中调用，工作线程中请使用 ws_pool_join。
+static inline void ws_pool_wait(struct ws_pool *pool)
+{
+    pthread_mutex_lock(&pool->park_lock);
+    while (atomic_load(&pool->pending) > 0)
+    {
+        pthread_cond_wait(&pool->done_cond, &pool->park_lock);
+    }
+    pthread_mutex_unlock(&pool->park_lock);
+}
+
+/// @brief 创建线程池
+/// @param nr_workers 工作线程数，小于等于 0 时使用在线 CPU 数
+/// @return 成功，返回指向线程池的指针。失败，返回 NULL。
+static inline struct ws_pool *ws_pool_create(int nr_workers)
+{
+    struct ws_pool *pool;
+    int i;
+
+    if (nr_workers <= 0)
+    {
+        nr_workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (nr_workers <= 0)
+        {
+            nr_workers = 1;
+        }
+    }
+
+    pool = (struct ws_pool *)calloc(1, sizeof(struct ws_pool));
+    if (pool == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    pool->workers = (struct ws_worker *)calloc(nr_workers, sizeof(struct ws_worker));
+    if (pool->workers == NULL)
+    {
+        perror("calloc");
+        free(pool);
+        return NULL;
+    }
+    pool->nr_workers = nr_workers;
+    pthread_mutex_init(&pool->park_lock, NULL);
+    pthread_cond_init(&pool->park_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (i = 0; i < nr_workers; i++)
+    {
+        struct ws_worker *w = &pool->workers[i];
+        pthread_mutex_init(&w->lock, NULL);
+        INIT_LIST_HEAD(&w->deque);
+        w->id = i;
+        w->seed = (unsigned int)i * 2654435761u + 1;
+        w->pool = pool;
+    }
+    for (i = 0; i < nr_workers; i++)
+    {
+        if (pthread_create(&pool->workers[i].tid, NULL, __ws_worker_main, &pool->workers[i]) != 0)
+        {
+            perror("pthread_create");
+            pool->nr_workers = i;
+            break;
+        }
+    }
+    if (pool->nr_workers == 0)
+    {
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+/// @brief 销毁线程池，先等待已提交的任务全部完成
+/// @param pool 指向线程池的指针
+static inline void ws_pool_destroy(struct ws_pool *pool)
+{
+    int i;
+
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    ws_pool_wait(pool);
+    pthread_mutex_lock(&pool->park_lock);
+    atomic_store(&pool->stop, 1);
+    pthread_cond_broadcast(&pool->park_cond);
+    pthread_mutex_unlock(&pool->park_lock);
+
+    // 还没退出的线程可能正在窃取其他线程的队列，全部退出后才能销毁各队列的锁
+    for (i = 0; i < pool->nr_workers; i++)
+    {
+        pthread_join(pool->workers[i].tid, NULL);
+    }
+    for (i = 0; i < pool->nr_workers; i++)
+    {
+        pthread_mutex_destroy(&pool->workers[i].lock);
+    }
+    pthread_mutex_destroy(&pool->park_lock);
+    pthread_cond_destroy(&pool->park_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    free(pool->workers);
+    free(pool);
+}
+
+#endif